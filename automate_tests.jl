@@ -10,13 +10,15 @@ using Dates
 # Importa o arquivo com sua função principal
 include("fli.jl")
 
-function run_all_instances()
+# ils_time > 0: a formulação parte da melhor solução de ils_time segundos de ILS
+# (número de times e solução inicial), com os resultados em resultados_ils.csv
+function run_all_instances(ils_time::Float64=0.0)
     base_path = "instances"
     time_limit = 300.0
     seeds = 0:9
 
     # Arquivo CSV de saída
-    results_file = "resultados.csv"
+    results_file = ils_time > 0 ? "resultados_ils.csv" : "resultados.csv"
 
     # Cria o DataFrame (se já existir, lê o existente)
     if isfile(results_file)
@@ -45,7 +47,7 @@ function run_all_instances()
             try
                 # Mede o tempo de execução e captura o valor retornado
                 tempo_total = @elapsed begin
-                    solucao_inicial, solucao = fli(filename, time_limit, seed)
+                    solucao_inicial, solucao = fli(filename, time_limit, seed; ils_time=ils_time)
                 end
 
                 # Adiciona linha no DataFrame
@@ -81,5 +83,35 @@ function run_all_instances()
     println("✅ Execuções concluídas! Resultados salvos em $results_file")
 end
 
-# Executa automaticamente se rodado diretamente
-run_all_instances()
+# Roda o ILS de ils_time.cpp no próprio processo (libils.so) com a mesma grade do Makefile
+# e grava as linhas no formato de ils_results.csv
+function run_ils_instances(time_limit::Float64=5.0)
+    results_file = "ils_lib_results.csv"
+    results_df = DataFrame(instance = String[], initial_solution = Int[], intermediate_solutions_number = Int[],
+                           final_solution = Int[], iterations = Int[], equivalent_time = Float64[],
+                           seed = Int[], perturbation_ratio = Float64[])
+
+    for i in 1:10
+        filename = joinpath("instances", lpad(i, 2, '0') * ".txt")
+        instancia = ils_load(filename)
+        for seed in 1:5, ratio in (0.15, 0.30)
+            _, stats = ils_solve(instancia; time_limit=time_limit, seed=seed, perturbation_ratio=ratio)
+            println("$filename seed=$seed ratio=$ratio: $(stats.teams) times ($(stats.iterations) iterações)")
+            push!(results_df, (filename, stats.initial_teams, stats.improvements, stats.teams,
+                               stats.iterations, time_limit, seed, ratio))
+        end
+        CSV.write(results_file, results_df)
+    end
+
+    println("✅ Execuções concluídas! Resultados salvos em $results_file")
+end
+
+# Executa automaticamente se rodado diretamente (`julia automate_tests.jl ils` roda o ILS,
+# `julia automate_tests.jl fli_ils [segundos]` roda a formulação a partir do ILS, default 10 s)
+if !isempty(ARGS) && ARGS[1] == "ils"
+    run_ils_instances()
+elseif !isempty(ARGS) && ARGS[1] == "fli_ils"
+    run_all_instances(length(ARGS) >= 2 ? parse(Float64, ARGS[2]) : 10.0)
+else
+    run_all_instances()
+end
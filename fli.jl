@@ -6,62 +6,25 @@ Pkg.instantiate()
 using JuMP
 using HiGHS
 
-struct Player
-        id::Int
-        salary::Int
-    end
-
-mutable struct Team
-    players::Vector{Int}
-    remaining_budget::Int
-end
-
-# (TODO) ATUALIZAR CONSTRUÇÃO CASA HAJA MUDANÇAS NO ils.cpp NESSA PARTE (TODO)
-function can_add_to_team(team::Team, pid::Int, salarios::Vector{Int}, conflitos::Vector{Tuple{Int,Int}})
-    # Verifica se há conflito entre pid e algum jogador já no time
-    for other in team.players
-        for (a, b) in conflitos
-            if (pid == a && other == b) || (pid == b && other == a)
-                return false
-            end
-        end
-    end
-    # Verifica orçamento
-    return salarios[pid] <= team.remaining_budget
-end
-
-function construct_initial_solution(B::Int, salarios::Vector{Int}, conflitos::Vector{Tuple{Int,Int}})
-    J = length(salarios)
-
-    # Ordena jogadores por salário decrescente (First Fit Decreasing)
-    order = sortperm(salarios; rev=true)
-
-    teams = Team[]
-
-    for pid in order
-        placed = false
-
-        # Tenta colocar no primeiro time viável
-        for team in teams
-            if can_add_to_team(team, pid, salarios, conflitos)
-                push!(team.players, pid)
-                team.remaining_budget -= salarios[pid]
-                placed = true
-                break
-            end
-        end
-
-        # Se não couber em nenhum time existente, cria um novo
-        if !placed
-            new_team = Team([pid], B - salarios[pid])
-            push!(teams, new_team)
-        end
-    end
+# Construção inicial e ILS feitos pela heurística em C++ (libils.so)
+include("libils.jl")
 
+# Lê uma solução gravada por `ils_time --save_solution` (número de times na primeira
+# linha, depois um time por linha com os ids dos jogadores a partir de 1)
+function read_solution_file(filename::String, J::Int)
+    lines = strip.(readlines(filename))
+    T = parse(Int, lines[1])
+    teams = [parse.(Int, split(lines[1 + t])) for t in 1:T]
+    sort(reduce(vcat, teams; init=Int[])) == collect(1:J) ||
+        error("$filename: cada jogador 1..$J deve estar em exatamente um time")
     return teams
 end
 
-function fli(filename::String, time_limit::Float64, seed::Int)
+# fli(arquivo, tempo, seed) resolve a formulação a partir da construção gulosa.
+# - solution_file: solução do ils_time (--save_solution) usada como solução inicial;
+# - ils_time > 0: roda antes o ILS da libils.so por esse tempo (em s) e usa a melhor solução.
+function fli(filename::String, time_limit::Float64, seed::Int;
+             solution_file::Union{Nothing,String}=nothing, ils_time::Float64=0.0)
     # Cria modelo HIGH com os parâmetors dados
     m = Model(HiGHS.Optimizer)
     set_optimizer_attribute(m, "time_limit", time_limit)
@@ -95,11 +58,24 @@ function fli(filename::String, time_limit::Float64, seed::Int)
     println("Conflitos I = $I")
 
     # ---- ENCONTRA SOLUÇÃO INICIAL ----
-    # Antes de rodar a formulação, rodamos a mesma construção 
-    # de times gulosa implementada na heuristica inicialmente
-    # para encontrar um valor menor para c_max_times para rodar a
-    # formulação com menos variáveis.
-    initial_teams = construct_initial_solution(B, salarios, conflitos)
+    # Antes de rodar a formulação, buscamos uma solução com a heurística
+    # (construção gulosa, ILS ou uma solução salva pelo ils_time) para
+    # rodar a formulação com menos variáveis: o número de times dela é
+    # o c_max_times, e ela é passada ao HiGHS como solução inicial.
+    if solution_file !== nothing
+        initial_teams = read_solution_file(solution_file, J)
+        println("Solução inicial lida de $solution_file")
+    elseif ils_time > 0
+        assignment, stats = ils_solve(ils_load(B, salarios, conflitos); time_limit=ils_time, seed=seed)
+        initial_teams = ils_teams(assignment)
+        println("Solução inicial do ILS: $(stats.teams) times em $(round(stats.seconds, digits=2)) s ($(stats.iterations) iterações)")
+    else
+        initial_teams = ils_teams(ils_construct(ils_load(B, salarios, conflitos), seed))
+    end
+
+    # Times ordenados pelo menor jogador, para respeitar a quebra de simetria abaixo
+    # (o time j tem como menor jogador um id >= j)
+    initial_teams = sort(filter(!isempty, initial_teams), by=minimum)
 
     # ---- FORMULAÇÃO LINEAR ----
     # - Variáveis
@@ -110,12 +86,10 @@ function fli(filename::String, time_limit::Float64, seed::Int)
     # -- xij significa botar jogador i no time j
     println("numero inicial de times = $c_max_times")
     @variable(m, x[1:J, 1:c_max_times], Bin, start=0)
-    index_team=1
-    for team in initial_teams
-        for player in team.players
+    for (index_team, team) in enumerate(initial_teams)
+        for player in team
             set_start_value(x[player, index_team], 1)
         end
-        index_team+=1
     end
 
     println("Solução inicial setada:")
@@ -167,21 +141,42 @@ function fli(filename::String, time_limit::Float64, seed::Int)
     # numero de restrições: J
     @constraint(m, [i=1:J], sum(x[i,1:c_max_times])==1)
 
+    # - quebra de simetria (trocar os índices de dois times não muda a solução)
+    # o jogador i só pode ir para os times 1..i: numerando os times pelo menor
+    # jogador de cada um, o time j tem como menor jogador um id >= j
+    # numero de variáveis fixadas: c_max_times * (c_max_times - 1) / 2
+    for i in 1:min(J, c_max_times), j in (i + 1):c_max_times
+        fix(x[i, j], 0; force=true)
+    end
+    # os times usados são os primeiros
+    # numero de restrições: c_max_times - 1
+    @constraint(m, [j=1:(c_max_times - 1)], y[j] >= y[j + 1])
+
+    # - limite inferior: a soma dos salários precisa caber nos budgets dos times usados
+    @constraint(m, sum(y[1:c_max_times]) >= ceil(Int, sum(salarios) / B))
+
     optimize!(m)
     return Int(c_max_times), Int(objective_value(m))
 end
 
 if abspath(PROGRAM_FILE) == @__FILE__
     # Pega o nome do arquivo passado na linha de comando
-    # Uso: julia fli.jl 07.txt
+    # Uso: julia fli.jl 07.txt 300 1 [--solution arquivo | --ils segundos]
     if length(ARGS) < 3
-        println("Uso: julia fli.jl <arquivo.txt> <tempo_max_s> <seed>")
+        println("Uso: julia fli.jl <arquivo.txt> <tempo_max_s> <seed> [--solution <solucao.txt> | --ils <tempo_ils_s>]")
         exit()
     end
     filename = ARGS[1]
     time_limit = parse(Float64, ARGS[2])
     seed = parse(Int, ARGS[3])
+    solution_file = nothing
+    ils_time = 0.0
+    if length(ARGS) >= 5 && ARGS[4] == "--solution"
+        solution_file = ARGS[5]
+    elseif length(ARGS) >= 5 && ARGS[4] == "--ils"
+        ils_time = parse(Float64, ARGS[5])
+    end
 
     # Chama o método definido para formulação
-    fli(filename, time_limit, seed)
-end
\ No newline at end of file
+    fli(filename, time_limit, seed; solution_file=solution_file, ils_time=ils_time)
+end
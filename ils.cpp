@@ -14,6 +14,11 @@
 
 using namespace std;
 
+// Per-iteration messages are only compiled in with -DILS_MAX_LOG_LEVEL=3 (same levels as ils_time.cpp)
+#ifndef ILS_MAX_LOG_LEVEL
+#define ILS_MAX_LOG_LEVEL 2
+#endif
+
 // ================= Structures ================= //
 struct Player {
     int id;
@@ -460,7 +465,9 @@ int main(int argc, char* argv[]) {
         // Compute local search with perturbation many times
         for(int i=0; i<max_iterations; i++){
             
+#if ILS_MAX_LOG_LEVEL >= 3
             cout << "Local search number " << (1+i) << "\n";
+#endif
             current_solution = local_search(current_solution, instance);
 
             if (current_solution.size() < best_solution.size()){
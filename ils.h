@@ -0,0 +1,119 @@
+/*
+ * C API of the heuristic (libils.so, built with "make libils.so").
+ *
+ * Players and teams are numbered from 1, as in the instance files. A solution is given as
+ * an assignment: assignment[i] is the team (1..number of teams) of player i + 1.
+ * Functions that can fail return a negative value (or NULL) and leave a message in
+ * ils_last_error(). Instances are read-only after loading, so the same instance can be
+ * solved from several threads at once.
+ */
+#ifndef ILS_H
+#define ILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ILS_API __attribute__((visibility("default")))
+
+#define ILS_API_VERSION 3
+
+typedef struct ils_instance ils_instance;
+
+/* Acceptance criteria of the ILS (see --acceptance of ils_time) */
+enum {
+    ILS_ACCEPT_ALWAYS = 0,
+    ILS_ACCEPT_BETTER_EQUAL = 1,
+    ILS_ACCEPT_SIMULATED_ANNEALING = 2,
+    ILS_ACCEPT_LATE_ACCEPTANCE = 3
+};
+
+/* Constructions of the initial solution (see --constructor of ils_time) */
+enum {
+    ILS_CONSTRUCT_FIRST_FIT = 0, /* random order */
+    ILS_CONSTRUCT_FFD = 1,       /* highest salary first */
+    ILS_CONSTRUCT_DEGREE = 2     /* most conflicts first */
+};
+
+typedef struct {
+    double time_limit;         /* seconds (default 5) */
+    int max_iterations;        /* also stop after this many iterations (0 = time limit only) */
+    uint64_t seed;             /* default 1 */
+    double perturbation_ratio; /* default 0.15 */
+    int pool_interval;         /* iterations between team pool recombinations (0 = disabled) */
+    int alns;                  /* nonzero: ALNS perturbation instead of the random one */
+    int acceptance;            /* ILS_ACCEPT_* (default ILS_ACCEPT_ALWAYS) */
+    int stagnation_limit;      /* local search iterations without improvement (default 20) */
+    int matching;              /* nonzero: stagnated local search matches the players First Fit leaves out */
+    int exact_interval;        /* iterations without a new best between exact repackings (0 = disabled) */
+    int64_t exact_nodes;       /* node limit of each exact repacking (default 100000) */
+    int constructor;           /* ILS_CONSTRUCT_* of the start when there is no initial assignment */
+} ils_params;
+
+typedef struct {
+    int initial_teams;  /* teams of the starting solution */
+    int teams;          /* teams of the best solution */
+    int improvements;   /* new best solutions found during the search */
+    int iterations;     /* ILS iterations done */
+    double seconds;     /* time spent in the call */
+} ils_stats;
+
+/* Version of this API (ILS_API_VERSION of the library) */
+ILS_API int ils_api_version(void);
+
+/* Message of the last error of the calling thread */
+ILS_API const char *ils_last_error(void);
+
+/* Loads an instance file (memory_cap_mb = 0: default cap for the conflict graph) */
+ILS_API ils_instance *ils_load_file(const char *path, size_t memory_cap_mb);
+
+/* Builds an instance from arrays: salaries[players], conflict_pairs[2 * conflicts] (1-based pairs) */
+ILS_API ils_instance *ils_load_arrays(int budget, int players, const int *salaries,
+                                      int conflicts, const int *conflict_pairs);
+
+ILS_API void ils_free_instance(ils_instance *instance);
+
+ILS_API int ils_player_count(const ils_instance *instance);
+
+/* Fills params with the defaults of ils_time */
+ILS_API void ils_default_params(ils_params *params);
+
+/*
+ * First Fit Decreasing construction (highest salary first; the seed breaks ties between equal
+ * salaries). Writes the assignment and returns the number of teams.
+ */
+ILS_API int ils_construct(const ils_instance *instance, uint64_t seed, int *assignment);
+
+/*
+ * Runs the ILS and writes the best assignment. initial_assignment may be NULL (the
+ * search then starts from the construction params->constructor) and stats may be NULL.
+ * Returns the number of teams of the best solution.
+ */
+ILS_API int ils_solve(const ils_instance *instance, const ils_params *params,
+                      const int *initial_assignment, int *assignment, ils_stats *stats);
+
+/*
+ * Applies a delta file (format in the README) to an instance and returns the updated
+ * instance; the given one stays valid. Ids of the players after the delta are those of
+ * ils_player_count(updated).
+ */
+ILS_API ils_instance *ils_apply_delta(const ils_instance *instance, const char *delta_path);
+
+/*
+ * Repairs an assignment of the instance a delta was applied to (previous_assignment, one
+ * entry per player before the delta) for the instance returned by ils_apply_delta: only the
+ * players that now violate a constraint, and the new ones, are reinserted by First Fit.
+ * ejected (may be NULL) receives how many. Returns the number of teams; the repaired
+ * assignment is a good initial_assignment for a short ils_solve.
+ */
+ILS_API int ils_repair(const ils_instance *updated, const int *previous_assignment, int *assignment,
+                       int *ejected);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -11,14 +11,40 @@
 #include <tuple>    
 #include <utility>  
 #include <chrono> 
+#include <unordered_map>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <memory>
+#include <csignal>
+#include <cstdio>
+#include <cmath>
+#include <bitset>
+#include <limits>
+#include <ctime>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include "ils.h"
 
 using namespace std;
 
 // ================= Structures ================= //
 struct Player {
     int id;
-    int salary;
-    vector<int> conflicts; // store indices of players it conflicts with
+    int salary; // the conflicts are in ProblemInstance::adjacency
 };
 
 struct Team {
@@ -27,54 +53,587 @@ struct Team {
 };
 
 // ================= Problem Data ================= //
+constexpr int SMALL_CLASS_PLAYERS = 128;
+constexpr int MEDIUM_CLASS_PLAYERS = 1024;
+constexpr size_t DEFAULT_MEMORY_CAP = 2048ull << 20; // bytes the conflict graph may use (--memory_cap)
+constexpr int DEFAULT_STAGNATION_LIMIT = 20; // local search iterations without improvement (--stagnation)
+constexpr size_t DENSE_MATRIX_FACTOR = 32; // a bit matrix is used if it is at most this many times the lists
+
+// How the conflict graph of an instance is stored, chosen once it is loaded (see build_adjacency)
+enum AdjacencyKind {
+    ADJ_BITSET_SMALL,  // J <= 128: bitset<128> rows
+    ADJ_BITSET_MEDIUM, // J <= 1024: bitset<1024> rows
+    ADJ_BITSET,        // dense graph: rows of ceil(J / 64) words
+    ADJ_CSR,           // sparse graph: sorted lists, membership by binary search
+    ADJ_VARINT         // huge sparse graph: delta-encoded varint lists, membership by a scan of one list
+};
+
+/**
+ * @brief Conflict graph of an instance. Every phase of the solver reads the conflicts through
+ *        it: neighbor lists (CSR or varint) always exist, and a bit matrix is added for the
+ *        membership test when the graph is small or dense enough.
+ */
+struct Adjacency {
+    AdjacencyKind kind = ADJ_CSR;
+    vector<bitset<SMALL_CLASS_PLAYERS>> small_rows;
+    vector<bitset<MEDIUM_CLASS_PLAYERS>> medium_rows;
+    vector<uint64_t> words; // ADJ_BITSET: row of player a starts at a * stride
+    size_t stride = 0;
+    vector<uint64_t> offsets; // list of player a: [offsets[a], offsets[a + 1]) of targets (or of bytes for ADJ_VARINT)
+    vector<int> targets; // sorted neighbor lists
+    vector<uint8_t> bytes; // ADJ_VARINT: sorted lists as LEB128 deltas
+    vector<int> varint_degrees; // ADJ_VARINT: list sizes
+
+    int degree(int a) const {
+        return kind == ADJ_VARINT ? varint_degrees[a] : (int)(offsets[a + 1] - offsets[a]);
+    }
+
+    /**
+     * @brief Calls f(b) for every conflict b of player a, in increasing order (repeated conflicts are kept).
+     */
+    template <class F>
+    void for_each_neighbor(int a, F &&f) const {
+        if (kind != ADJ_VARINT) {
+            for (uint64_t k = offsets[a]; k < offsets[a + 1]; k++) f(targets[k]);
+            return;
+        }
+        uint64_t k = offsets[a], end = offsets[a + 1];
+        int value = 0;
+        while (k < end) {
+            uint32_t delta = 0;
+            int shift = 0;
+            uint8_t byte;
+            do {
+                byte = bytes[k++];
+                delta |= (uint32_t)(byte & 0x7f) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            value += delta;
+            f(value);
+        }
+    }
+
+    size_t memory_bytes() const {
+        return small_rows.size() * sizeof(small_rows[0]) + medium_rows.size() * sizeof(medium_rows[0])
+             + (words.size() + offsets.size()) * sizeof(uint64_t) + (targets.size() + varint_degrees.size()) * sizeof(int)
+             + bytes.size();
+    }
+};
+
 struct ProblemInstance {
     int J; // number of players
     int I; // number of conflicts
     int B; // budget per team
     vector<Player> players;
+    shared_ptr<const Adjacency> adjacency; // conflict graph, shared by copies of the instance
+    size_t memory_cap = DEFAULT_MEMORY_CAP; // limit for the adjacency (kept for reduced copies)
+};
+
+/**
+ * @brief Name of an adjacency representation, for logs.
+ */
+const char *adjacency_name(AdjacencyKind kind) {
+    switch (kind) {
+        case ADJ_BITSET_SMALL: return "bitset<128>";
+        case ADJ_BITSET_MEDIUM: return "bitset<1024>";
+        case ADJ_BITSET: return "bit matrix";
+        case ADJ_CSR: return "CSR";
+        default: return "varint lists";
+    }
+}
+
+
+// ================= Conflict Engines ================= //
+// Each engine answers "do players a and b conflict?" for one adjacency representation.
+// The search kernels are templated on the engine, so every representation gets its own
+// instantiation (with the row width known at compile time for the fixed bitsets);
+// with_conflict_engine picks it at run time.
+
+template <size_t N>
+struct FixedBitsetEngine {
+    const bitset<N> *rows;
+    bool conflict(int a, int b) const { return rows[a][b]; }
 };
 
+struct DynamicBitsetEngine {
+    const uint64_t *words;
+    size_t stride;
+    bool conflict(int a, int b) const { return (words[a * stride + (b >> 6)] >> (b & 63)) & 1; }
+};
+
+struct CsrEngine {
+    const uint64_t *offsets;
+    const int *targets;
+    bool conflict(int a, int b) const { return binary_search(targets + offsets[a], targets + offsets[a + 1], b); }
+};
+
+struct VarintEngine {
+    const uint64_t *offsets;
+    const uint8_t *bytes;
+    bool conflict(int a, int b) const {
+        int value = 0;
+        for (uint64_t k = offsets[a], end = offsets[a + 1]; k < end;) {
+            uint32_t delta = 0;
+            for (int shift = 0;; shift += 7) {
+                uint8_t byte = bytes[k++];
+                delta |= (uint32_t)(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            value += delta;
+            if (value >= b) return value == b; // lists are sorted
+        }
+        return false;
+    }
+};
 
 /**
- * @brief Prints the current solution (teams and players) in a formatted table.
+ * @brief Builds the conflict graph of an instance and picks its representation.
  * 
- * @param teams Vector of teams containing players and remaining budgets.
+ * @details The sorted lists are kept as CSR (8 bytes per conflict) when that fits in
+ *          instance.memory_cap, otherwise as delta-encoded varints (usually 2 bytes per
+ *          conflict); instances with J <= 1024 also get fixed-size bitset rows, and larger
+ *          ones a bit matrix when it fits in the cap and is at most DENSE_MATRIX_FACTOR
+ *          times the size of the lists. The cap bounds what stays resident; while building,
+ *          the edge list and the CSR exist at the same time.
+ * 
+ * @param instance The problem instance; its adjacency is replaced.
+ * @param edges The conflicts (0-based pairs; a repeated pair is kept twice).
  * 
  * @return void
+ * @throws runtime_error If not even the varint lists fit in the memory cap.
+ */
+void build_adjacency(ProblemInstance &instance, const vector<pair<int,int>> &edges) {
+    auto adj = make_shared<Adjacency>();
+    size_t J = instance.J;
+    size_t cap = instance.memory_cap;
+
+    // Sorted CSR by counting sort
+    adj->offsets.assign(J + 1, 0);
+    for (const auto &e : edges) {
+        adj->offsets[e.first + 1]++;
+        adj->offsets[e.second + 1]++;
+    }
+    for (size_t a = 0; a < J; a++) adj->offsets[a + 1] += adj->offsets[a];
+    adj->targets.resize(adj->offsets[J]);
+    vector<uint64_t> next(adj->offsets.begin(), adj->offsets.end() - 1);
+    for (const auto &e : edges) {
+        adj->targets[next[e.first]++] = e.second;
+        adj->targets[next[e.second]++] = e.first;
+    }
+    vector<uint64_t>().swap(next);
+    for (size_t a = 0; a < J; a++) sort(adj->targets.begin() + adj->offsets[a], adj->targets.begin() + adj->offsets[a + 1]);
+
+    // Too large: re-encode as varint deltas
+    if (adj->memory_bytes() > cap) {
+        adj->kind = ADJ_VARINT;
+        adj->varint_degrees.resize(J);
+        vector<uint64_t> byte_offsets(J + 1, 0);
+        for (size_t a = 0; a < J; a++) {
+            adj->varint_degrees[a] = (int)(adj->offsets[a + 1] - adj->offsets[a]);
+            int previous = 0;
+            for (uint64_t k = adj->offsets[a]; k < adj->offsets[a + 1]; k++) {
+                uint32_t delta = adj->targets[k] - previous;
+                previous = adj->targets[k];
+                do {
+                    uint8_t byte = delta & 0x7f;
+                    delta >>= 7;
+                    adj->bytes.push_back(delta ? byte | 0x80 : byte);
+                } while (delta);
+            }
+            byte_offsets[a + 1] = adj->bytes.size();
+        }
+        adj->bytes.shrink_to_fit();
+        adj->offsets = move(byte_offsets);
+        vector<int>().swap(adj->targets);
+        if (adj->memory_bytes() > cap) {
+            throw runtime_error("conflict graph needs " + to_string((adj->memory_bytes() + (1 << 20) - 1) >> 20) + " MB, above the memory cap of "
+                                + to_string(cap >> 20) + " MB");
+        }
+    }
+
+    // Bit matrix for the membership test
+    size_t lists = adj->memory_bytes();
+    size_t matrix = J * ((J + 63) / 64) * sizeof(uint64_t);
+    auto fill = [&](auto &rows) {
+        rows.resize(J);
+        for (const auto &e : edges) {
+            rows[e.first][e.second] = true;
+            rows[e.second][e.first] = true;
+        }
+    };
+    if (J <= SMALL_CLASS_PLAYERS) {
+        adj->kind = ADJ_BITSET_SMALL;
+        fill(adj->small_rows);
+    } else if (J <= MEDIUM_CLASS_PLAYERS) {
+        adj->kind = ADJ_BITSET_MEDIUM;
+        fill(adj->medium_rows);
+    } else if (lists + matrix <= cap && matrix <= DENSE_MATRIX_FACTOR * lists) {
+        adj->kind = ADJ_BITSET;
+        adj->stride = (J + 63) / 64;
+        adj->words.assign(J * adj->stride, 0);
+        for (const auto &e : edges) {
+            adj->words[e.first * adj->stride + (e.second >> 6)] |= 1ull << (e.second & 63);
+            adj->words[e.second * adj->stride + (e.first >> 6)] |= 1ull << (e.first & 63);
+        }
+    }
+    instance.adjacency = move(adj);
+}
+
+/**
+ * @brief Runtime dispatcher: calls f with the conflict engine of the adjacency of the instance.
+ * 
+ * @param instance The problem instance with players and constraints.
+ * @param f Generic callable taking the engine (const auto &); all instantiations must return the same type.
+ * 
+ * @return What f returns.
+ */
+template <class F>
+auto with_conflict_engine(const ProblemInstance &instance, F &&f) {
+    const Adjacency &adj = *instance.adjacency;
+    switch (adj.kind) {
+        case ADJ_BITSET_SMALL:
+            return f(FixedBitsetEngine<SMALL_CLASS_PLAYERS>{adj.small_rows.data()});
+        case ADJ_BITSET_MEDIUM:
+            return f(FixedBitsetEngine<MEDIUM_CLASS_PLAYERS>{adj.medium_rows.data()});
+        case ADJ_BITSET:
+            return f(DynamicBitsetEngine{adj.words.data(), adj.stride});
+        case ADJ_CSR:
+            return f(CsrEngine{adj.offsets.data(), adj.targets.data()});
+        default:
+            return f(VarintEngine{adj.offsets.data(), adj.bytes.data()});
+    }
+}
+
+
+// ================= Random Numbers ================= //
+/**
+ * @brief xoshiro256** generator (usable with the <random> distributions and std::shuffle).
+ * 
+ * @details Seeded through splitmix64. split() hands out a non-overlapping stream: the child
+ *          continues from the current state and the parent jumps 2^128 numbers ahead, so
+ *          every thread can own its own generator while runs stay reproducible.
+ */
+struct Rng {
+    using result_type = uint64_t;
+    uint64_t s[4];
+
+    explicit Rng(uint64_t seed = 0) {
+        for (auto &word : s) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    result_type operator()() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    /**
+     * @brief Advances the generator by 2^128 numbers.
+     * 
+     * @return void
+     */
+    void jump() {
+        static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        uint64_t t[4] = {0, 0, 0, 0};
+        for (uint64_t mask : JUMP) {
+            for (int b = 0; b < 64; b++) {
+                if (mask & (1ULL << b)) {
+                    for (int w = 0; w < 4; w++) t[w] ^= s[w];
+                }
+                (*this)();
+            }
+        }
+        for (int w = 0; w < 4; w++) s[w] = t[w];
+    }
+
+    /**
+     * @brief Returns an independent generator for another thread or task.
+     * 
+     * @return Rng The child generator.
+     */
+    Rng split() {
+        Rng child = *this;
+        jump();
+        return child;
+    }
+
+    /**
+     * @brief Uniform integer in [0, bound) (bound > 0), by multiply-shift.
+     * 
+     * @param bound Exclusive upper bound.
+     * 
+     * @return uint64_t The number drawn.
+     */
+    uint64_t below(uint64_t bound) {
+        return (uint64_t)(((unsigned __int128)(*this)() * bound) >> 64);
+    }
+};
+
+ostream &operator<<(ostream &out, const Rng &rng) {
+    return out << rng.s[0] << " " << rng.s[1] << " " << rng.s[2] << " " << rng.s[3];
+}
+
+istream &operator>>(istream &in, Rng &rng) {
+    return in >> rng.s[0] >> rng.s[1] >> rng.s[2] >> rng.s[3];
+}
+
+// ================= Deadlines ================= //
+constexpr int DEADLINE_CHECK_INTERVAL = 16; // work units (neighbor evaluations, reinsertions) between clock reads
+
+/**
+ * @brief Reads the coarse monotonic clock (no system call, resolution of one kernel tick).
+ * 
+ * @return int64_t Nanoseconds since an arbitrary origin.
+ */
+inline int64_t coarse_now_ns() {
+    timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Time limit of a search, polled from inside local_search and perturbation so that a
+ *        single long local search cannot run far past it.
+ * 
+ * @details expired() only reads the clock once every DEADLINE_CHECK_INTERVAL calls, so the
+ *          loops can call it for every unit of work. Once reached, it stays reached. Copies
+ *          are independent (one per thread). A default-constructed deadline never expires.
+ */
+struct Deadline {
+    int64_t end_ns = INT64_MAX; // coarse clock value at which the search stops
+    int countdown = DEADLINE_CHECK_INTERVAL;
+    bool reached = false;
+
+    Deadline() = default;
+
+    /**
+     * @param start Start time of the run.
+     * @param seconds Time limit, counted from start.
+     */
+    Deadline(chrono::high_resolution_clock::time_point start, double seconds) {
+        double remaining = seconds - chrono::duration_cast<chrono::duration<double>>(chrono::high_resolution_clock::now() - start).count();
+        double remaining_ns = max(0.0, remaining) * 1e9;
+        if (remaining_ns < 4e18) end_ns = coarse_now_ns() + (int64_t)remaining_ns;
+    }
+
+    /**
+     * @brief Amortized check, to be called once per unit of work.
+     * 
+     * @return true If the deadline has been reached.
+     */
+    bool expired() {
+        if (reached) return true;
+        if (--countdown > 0) return false;
+        countdown = DEADLINE_CHECK_INTERVAL;
+        return expired_now();
+    }
+
+    /**
+     * @brief Reads the clock now (between iterations of the outer loops).
+     * 
+     * @return true If the deadline has been reached.
+     */
+    bool expired_now() {
+        if (!reached && end_ns != INT64_MAX) reached = coarse_now_ns() >= end_ns;
+        return reached;
+    }
+};
+
+// ================= Logging ================= //
+enum LogLevel {
+    LOG_ERROR = 0, // nothing but errors (which always go to cerr)
+    LOG_INFO = 1,  // run summary and new best team counts
+    LOG_DEBUG = 2, // full solution tables of every new best
+    LOG_TRACE = 3  // every ILS iteration and local search step
+};
+
+// Messages above this level are compiled out (build with -DILS_MAX_LOG_LEVEL=3 for traces)
+#ifndef ILS_MAX_LOG_LEVEL
+#define ILS_MAX_LOG_LEVEL LOG_DEBUG
+#endif
+
+/**
+ * @brief Asynchronous logger: callers format their message and push it into a bounded
+ *        lock-free ring buffer (multi-producer, single-consumer); a background thread,
+ *        started by the first message, drains the buffer and writes to output in large blocks.
+ *        In the library build nothing is logged unless the host raises the level, so loading
+ *        libils.so starts no thread and writes nothing to the host's stdout.
+ */
+class Logger {
+public:
+#ifdef ILS_LIBRARY
+    int level = LOG_ERROR; // runtime verbosity
+#else
+    int level = LOG_INFO; // runtime verbosity
+#endif
+    FILE *output = stdout; // where the messages go (set before the first message)
+
+    Logger() : slots(CAPACITY) {
+        for (size_t i = 0; i < CAPACITY; i++) slots[i].sequence.store(i, memory_order_relaxed);
+    }
+
+    ~Logger() {
+        stopping = true;
+        if (drainer.joinable()) drainer.join();
+    }
+
+    /**
+     * @brief Queues a formatted message. Spins (yielding) while the buffer is full.
+     * 
+     * @param message The message, including its newlines.
+     * 
+     * @return void
+     */
+    void push(string message) {
+        call_once(started, [this]() { drainer = thread([this]() { drain(); }); });
+        size_t pos = enqueue_pos.load(memory_order_relaxed);
+        while (true) {
+            Slot &slot = slots[pos & (CAPACITY - 1)];
+            size_t seq = slot.sequence.load(memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    slot.message = move(message);
+                    slot.sequence.store(pos + 1, memory_order_release);
+                    return;
+                }
+            } else if (diff < 0) {
+                this_thread::yield(); // full: wait for the drainer
+                pos = enqueue_pos.load(memory_order_relaxed);
+            } else {
+                pos = enqueue_pos.load(memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t CAPACITY = 1024; // power of two
+    struct Slot {
+        atomic<size_t> sequence;
+        string message;
+    };
+    vector<Slot> slots;
+    atomic<size_t> enqueue_pos{0};
+    size_t dequeue_pos = 0; // only touched by the drainer
+    atomic<bool> stopping{false};
+    once_flag started;
+    thread drainer;
+
+    /**
+     * @brief Background loop: moves queued messages to output until the logger is destroyed.
+     * 
+     * @return void
+     */
+    void drain() {
+        string block;
+        while (true) {
+            bool stop_after = stopping.load();
+            while (true) {
+                Slot &slot = slots[dequeue_pos & (CAPACITY - 1)];
+                if (slot.sequence.load(memory_order_acquire) != dequeue_pos + 1) break;
+                block += slot.message;
+                slot.message.clear();
+                slot.sequence.store(dequeue_pos + CAPACITY, memory_order_release);
+                dequeue_pos++;
+                if (block.size() >= (1 << 16)) {
+                    fwrite(block.data(), 1, block.size(), output);
+                    block.clear();
+                }
+            }
+            if (!block.empty()) {
+                fwrite(block.data(), 1, block.size(), output);
+                fflush(output);
+                block.clear();
+            } else if (stop_after) {
+                return;
+            } else {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        }
+    }
+};
+
+Logger logger;
+
+// Formats and queues a message if its level is enabled; a message above
+// ILS_MAX_LOG_LEVEL costs nothing at runtime
+#define LOG(msg_level, message)                               \
+    do {                                                      \
+        if constexpr ((msg_level) <= ILS_MAX_LOG_LEVEL) {     \
+            if ((msg_level) <= logger.level) {                \
+                ostringstream log_stream_;                    \
+                log_stream_ << message;                       \
+                logger.push(log_stream_.str());               \
+            }                                                 \
+        }                                                     \
+    } while (0)
+
+/**
+ * @brief Formats the current solution (teams and players) as a table.
+ * 
+ * @param teams Vector of teams containing players and remaining budgets.
+ * 
+ * @return string The formatted table.
  */
-void print_solution(const vector<Team> &teams) {
-    cout << "\n========== Current Solution ==========\n";
-    cout << "Total teams: " << teams.size() << "\n\n";
+string format_solution(const vector<Team> &teams) {
+    ostringstream out;
+    out << "\n========== Current Solution ==========\n";
+    out << "Total teams: " << teams.size() << "\n\n";
 
     // Print table header
-    cout << left << setw(8) << "Team"
+    out << left << setw(8) << "Team"
          << setw(15) << "Budget"
          << "Players (id:salary)\n";
-    cout << string(50, '-') << "\n";
+    out << string(50, '-') << "\n";
 
     // Print each team
     for (int t = 0; t < (int)teams.size(); t++) {
-        cout << left << setw(8) << t
+        out << left << setw(8) << t
              << setw(15) << teams[t].remaining_budget;
 
         for (int pid : teams[t].players) {
-            cout << pid << ", ";
+            out << pid << ", ";
         }
-        cout << "\n";
+        out << "\n";
     }
-    cout << "======================================\n";
+    out << "======================================\n";
+    return out.str();
 }
 
 /**
  * @brief Reads a problem instance from a file.
  * 
  * @param filename The name of the file containing the instance data.
+ * @param memory_cap Bytes the conflict graph may use (see build_adjacency).
  * 
  * @return ProblemInstance The populated problem instance with players, conflicts, and budget.
- * @throws runtime_error If the file cannot be opened.
+ * @throws runtime_error If the file cannot be opened or the conflict graph does not fit in memory_cap.
  */
-ProblemInstance read_instance(const string &filename) {
+ProblemInstance read_instance(const string &filename, size_t memory_cap = DEFAULT_MEMORY_CAP) {
     ProblemInstance instance;
+    instance.memory_cap = memory_cap;
     ifstream in(filename);
     if (!in.is_open()) {
         throw runtime_error("Could not open file " + filename);
@@ -97,327 +656,4588 @@ ProblemInstance read_instance(const string &filename) {
     }
 
     // Next I lines: conflicts
+    vector<pair<int,int>> edges(instance.I);
     for (int k = 0; k < instance.I; k++) {
         int u, v;
         in >> u >> v;
+        if (u < 1 || v < 1 || u > instance.J || v > instance.J) {
+            throw runtime_error("Conflict " + to_string(u) + " " + to_string(v) + " refers to an unknown player");
+        }
         // Convert to 0-based indexing
-        u--; v--;
-        instance.players[u].conflicts.push_back(v);
-        instance.players[v].conflicts.push_back(u);
+        edges[k] = {u - 1, v - 1};
     }
 
+    build_adjacency(instance, edges);
     return instance;
 }
 
 /**
- * @brief Checks if a player can be added to a given team.
+ * @brief Writes an instance in the format read by read_instance.
+ * 
+ * @param out Output stream.
+ * @param instance The problem instance.
+ * 
+ * @return void
+ */
+void write_instance(ostream &out, const ProblemInstance &instance) {
+    vector<pair<int,int>> edges;
+    for (int pid = 0; pid < instance.J; pid++) {
+        instance.adjacency->for_each_neighbor(pid, [&](int other) {
+            if (other > pid) edges.push_back({pid, other});
+        });
+    }
+    out << instance.B << "\n" << instance.J << " " << edges.size() << "\n";
+    for (const auto &player : instance.players) out << player.salary << "\n";
+    for (const auto &e : edges) out << e.first + 1 << " " << e.second + 1 << "\n";
+}
+
+// ================= Preprocessing ================= //
+struct Reduction {
+    ProblemInstance reduced; // instance the search works on
+    vector<int> original_id; // reduced player id -> original player id
+    vector<int> reduced_id; // original player id -> reduced player id (-1 if fixed)
+    vector<Team> fixed_teams; // singleton teams (original ids) removed from the search
+    int duplicate_edges = 0; // repeated conflicts dropped
+    int dead_edges = 0; // conflicts dropped because the pair never fits in one budget
+    int lower_bound = 0; // lower bound on the number of teams of the original instance
+};
+
+/**
+ * @brief Reduces a problem instance before the search.
+ * 
+ * @details 1. Drops repeated conflicts (and self conflicts).
+ *          2. Drops conflicts that can never bind: the two salaries together exceed B.
+ *          3. Fixes as singleton teams the players that must be alone: their salary plus the
+ *             lowest salary of a compatible partner exceeds B. They leave the search.
+ *          4. Players with salary above B/2 pairwise never fit together, so their count
+ *             (and the total salary over B) bound the number of teams from below.
+ *          The remaining players are renumbered from 0.
+ * 
+ * @param instance The original problem instance.
+ * 
+ * @return Reduction The reduced instance and the data needed to map solutions back.
+ */
+Reduction reduce_instance(const ProblemInstance &instance) {
+    Reduction r;
+    int J = instance.J;
+
+    // Clean conflict lists
+    vector<vector<int>> conflicts(J);
+    for (int i = 0; i < J; i++) {
+        const Player &p = instance.players[i];
+        auto &list = conflicts[i];
+        instance.adjacency->for_each_neighbor(i, [&](int other) { list.push_back(other); }); // already sorted
+        size_t before = list.size();
+        list.erase(unique(list.begin(), list.end()), list.end());
+        r.duplicate_edges += (int)(before - list.size());
+        list.erase(remove(list.begin(), list.end(), i), list.end());
+        size_t alive = list.size();
+        list.erase(remove_if(list.begin(), list.end(), [&](int other) {
+            return p.salary + instance.players[other].salary > instance.B;
+        }), list.end());
+        r.dead_edges += (int)(alive - list.size());
+    }
+    r.duplicate_edges /= 2;
+    r.dead_edges /= 2;
+
+    // Players sorted by salary, for finding the cheapest compatible partner
+    vector<int> by_salary(J);
+    iota(by_salary.begin(), by_salary.end(), 0);
+    stable_sort(by_salary.begin(), by_salary.end(), [&](int a, int b) {
+        return instance.players[a].salary < instance.players[b].salary;
+    });
+
+    // Find players that must be alone
+    vector<char> alone(J, 0);
+    long long total_salary = 0;
+    int big_players = 0;
+    for (int i = 0; i < J; i++) {
+        const Player &p = instance.players[i];
+        total_salary += p.salary;
+        if (2 * p.salary > instance.B) big_players++;
+
+        // The cheapest partner is among the first deg+2 entries of by_salary
+        int partner_salary = -1;
+        for (int pid : by_salary) {
+            if (pid == i || binary_search(conflicts[i].begin(), conflicts[i].end(), pid)) continue;
+            partner_salary = instance.players[pid].salary;
+            break;
+        }
+        if (partner_salary == -1 || p.salary + partner_salary > instance.B) alone[i] = 1;
+    }
+    r.lower_bound = max<int>(big_players, (int)((total_salary + instance.B - 1) / instance.B));
+
+    // Renumber the remaining players
+    vector<int> &new_id = r.reduced_id;
+    new_id.assign(J, -1);
+    for (int i = 0; i < J; i++) {
+        if (alone[i]) {
+            Team team;
+            team.remaining_budget = instance.B - instance.players[i].salary;
+            team.players.push_back(i);
+            r.fixed_teams.push_back(move(team));
+        } else {
+            new_id[i] = (int)r.original_id.size();
+            r.original_id.push_back(i);
+        }
+    }
+
+    r.reduced.B = instance.B;
+    r.reduced.J = (int)r.original_id.size();
+    r.reduced.memory_cap = instance.memory_cap;
+    r.reduced.players.resize(r.reduced.J);
+    vector<pair<int,int>> kept_edges;
+    for (int k = 0; k < r.reduced.J; k++) {
+        int i = r.original_id[k];
+        Player &q = r.reduced.players[k];
+        q.id = k;
+        q.salary = instance.players[i].salary;
+        for (int other : conflicts[i]) {
+            if (new_id[other] > k) kept_edges.push_back({k, new_id[other]});
+        }
+    }
+    r.reduced.I = (int)kept_edges.size();
+    vector<vector<int>>().swap(conflicts);
+    build_adjacency(r.reduced, kept_edges);
+
+    return r;
+}
+
+/**
+ * @brief Maps a solution of the reduced instance back to the original instance.
+ * 
+ * @param solution Solution of the reduced instance.
+ * @param r The reduction used to build the reduced instance.
+ * 
+ * @return vector<Team> The equivalent solution with original player ids, including the fixed teams.
+ */
+vector<Team> expand_solution(const vector<Team> &solution, const Reduction &r) {
+    vector<Team> expanded = r.fixed_teams;
+    for (const auto &team : solution) {
+        Team t;
+        t.remaining_budget = team.remaining_budget;
+        for (int pid : team.players) t.players.push_back(r.original_id[pid]);
+        expanded.push_back(move(t));
+    }
+    return expanded;
+}
+
+/**
+ * @brief Maps a solution of the original instance onto the reduced instance.
+ * 
+ * @details Players fixed by the reduction are dropped (they are in singleton teams
+ *          in any feasible solution) and teams left empty are removed.
+ * 
+ * @param solution Solution of the original instance.
+ * @param r The reduction used to build the reduced instance.
+ * 
+ * @return vector<Team> The equivalent solution of the reduced instance.
+ */
+vector<Team> restrict_solution(const vector<Team> &solution, const Reduction &r) {
+    vector<Team> restricted;
+    for (const auto &team : solution) {
+        Team t;
+        t.remaining_budget = team.remaining_budget;
+        for (int pid : team.players) {
+            if (r.reduced_id[pid] != -1) t.players.push_back(r.reduced_id[pid]);
+        }
+        if (!t.players.empty()) restricted.push_back(move(t));
+    }
+    return restricted;
+}
+
+// Player numbering the search works with (see renumber_instance)
+enum PlayerOrder {
+    ORDER_INPUT,  // ids of the instance file
+    ORDER_RCM,    // reverse Cuthill-McKee of the conflict graph
+    ORDER_DEGREE, // most conflicts first, then highest salary
+    PLAYER_ORDER_COUNT
+};
+
+const char *player_order_name(PlayerOrder order) {
+    static const char *names[] = {"none", "rcm", "degree"};
+    return names[order];
+}
+
+/**
+ * @brief Parses the name of a player order.
+ * 
+ * @param name "none", "rcm" or "degree".
+ * 
+ * @return PlayerOrder The order.
+ * @throws runtime_error If the name is unknown.
+ */
+PlayerOrder parse_player_order(const string &name) {
+    for (int o = 0; o < PLAYER_ORDER_COUNT; o++) {
+        if (name == player_order_name((PlayerOrder)o)) return (PlayerOrder)o;
+    }
+    throw runtime_error("Unknown player order: " + name);
+}
+
+struct Renumbering {
+    ProblemInstance renumbered; // instance the search works on
+    vector<int> original_id; // new player id -> player id before the renumbering
+    vector<int> new_id; // player id before the renumbering -> new player id
+};
+
+/**
+ * @brief Renumbers the players so that the conflicts of a player (and the bit matrix rows and
+ *        list entries read together in the hot loops) are close in memory.
+ * 
+ * @details ORDER_RCM numbers the players by a breadth-first search of every component of the
+ *          conflict graph, started from a player of lowest degree and visiting neighbors by
+ *          increasing degree, then reverses the numbering: neighbors get nearby ids, so their
+ *          bits fall in few words and their lists in few cache lines. ORDER_DEGREE puts the
+ *          players with the most conflicts (the ones tested most often) first.
+ * 
+ * @param instance The problem instance.
+ * @param order The new numbering.
+ * 
+ * @return Renumbering The renumbered instance and the data needed to map solutions back.
+ */
+Renumbering renumber_instance(const ProblemInstance &instance, PlayerOrder order) {
+    Renumbering r;
+    int J = instance.J;
+    const Adjacency &adj = *instance.adjacency;
+    vector<int> &original_id = r.original_id;
+    original_id.resize(J);
+    iota(original_id.begin(), original_id.end(), 0);
+
+    auto by_degree = [&](int a, int b) { return adj.degree(a) < adj.degree(b); };
+    if (order == ORDER_RCM) {
+        vector<int> roots = original_id;
+        stable_sort(roots.begin(), roots.end(), by_degree);
+        vector<char> visited(J, 0);
+        vector<int> neighbors;
+        original_id.clear();
+        for (int root : roots) {
+            if (visited[root]) continue;
+            visited[root] = 1;
+            size_t k = original_id.size();
+            original_id.push_back(root);
+            for (; k < original_id.size(); k++) {
+                neighbors.clear();
+                adj.for_each_neighbor(original_id[k], [&](int other) {
+                    if (!visited[other]) {
+                        visited[other] = 1;
+                        neighbors.push_back(other);
+                    }
+                });
+                stable_sort(neighbors.begin(), neighbors.end(), by_degree);
+                original_id.insert(original_id.end(), neighbors.begin(), neighbors.end());
+            }
+        }
+        reverse(original_id.begin(), original_id.end());
+    } else if (order == ORDER_DEGREE) {
+        stable_sort(original_id.begin(), original_id.end(), [&](int a, int b) {
+            if (adj.degree(a) != adj.degree(b)) return adj.degree(a) > adj.degree(b);
+            return instance.players[a].salary > instance.players[b].salary;
+        });
+    }
+
+    r.new_id.assign(J, -1);
+    for (int k = 0; k < J; k++) r.new_id[original_id[k]] = k;
+
+    r.renumbered.B = instance.B;
+    r.renumbered.J = J;
+    r.renumbered.memory_cap = instance.memory_cap;
+    r.renumbered.players.resize(J);
+    vector<pair<int,int>> edges;
+    edges.reserve(instance.I);
+    for (int k = 0; k < J; k++) {
+        r.renumbered.players[k] = {k, instance.players[original_id[k]].salary};
+        adj.for_each_neighbor(original_id[k], [&](int other) {
+            if (r.new_id[other] > k) edges.push_back({k, r.new_id[other]});
+        });
+    }
+    r.renumbered.I = (int)edges.size();
+    build_adjacency(r.renumbered, edges);
+    return r;
+}
+
+/**
+ * @brief Renames the players of a solution.
+ * 
+ * @param solution The solution.
+ * @param id New id of every player (Renumbering::new_id, or original_id to map back).
+ * 
+ * @return vector<Team> The same teams with the new player ids.
+ */
+vector<Team> rename_players(const vector<Team> &solution, const vector<int> &id) {
+    vector<Team> renamed = solution;
+    for (auto &team : renamed) {
+        for (int &pid : team.players) pid = id[pid];
+    }
+    return renamed;
+}
+
+// ================= Solution Files ================= //
+/**
+ * @brief Writes a solution: the number of teams, then one team per line
+ *        with its player ids (1-based, as in the instance file).
+ * 
+ * @param out Output stream.
+ * @param solution The solution to write.
+ * 
+ * @return void
+ */
+void write_solution(ostream &out, const vector<Team> &solution) {
+    out << solution.size() << "\n";
+    for (const auto &team : solution) {
+        for (size_t k = 0; k < team.players.size(); k++) {
+            out << (k ? " " : "") << team.players[k] + 1;
+        }
+        out << "\n";
+    }
+}
+
+/**
+ * @brief Reads a solution written by write_solution and recomputes the team budgets.
+ * 
+ * @param in Input stream.
+ * @param instance The problem instance the solution belongs to.
+ * 
+ * @return vector<Team> The solution read.
+ * @throws runtime_error If the stream is malformed or a player id is out of range.
+ */
+vector<Team> read_solution(istream &in, const ProblemInstance &instance) {
+    int T;
+    if (!(in >> T) || T < 0) throw runtime_error("Malformed solution: missing number of teams");
+    string line;
+    getline(in, line); // rest of the count line
+
+    vector<Team> solution(T);
+    for (auto &team : solution) {
+        if (!getline(in, line)) throw runtime_error("Malformed solution: expected " + to_string(T) + " teams");
+        istringstream ls(line);
+        team.remaining_budget = instance.B;
+        int pid;
+        while (ls >> pid) {
+            if (pid < 1 || pid > instance.J) throw runtime_error("Malformed solution: player " + to_string(pid) + " out of range");
+            team.players.push_back(pid - 1);
+            team.remaining_budget -= instance.players[pid - 1].salary;
+        }
+    }
+    return solution;
+}
+
+/**
+ * @brief Checks that a solution is feasible in O(J + I).
+ * 
+ * @param solution The solution to check.
+ * @param instance The problem instance with players and constraints.
+ * @param error Output: description of the first violation found.
+ * 
+ * @return true If every player is in exactly one team, no budget is exceeded and no team has a conflict.
+ * @return false Otherwise.
+ */
+bool validate_solution(const vector<Team> &solution, const ProblemInstance &instance, string &error) {
+    vector<int> team_of(instance.J, -1);
+    for (int t = 0; t < (int)solution.size(); t++) {
+        long long load = 0;
+        for (int pid : solution[t].players) {
+            if (pid < 0 || pid >= instance.J) {
+                error = "player " + to_string(pid + 1) + " out of range";
+                return false;
+            }
+            if (team_of[pid] == t) {
+                error = "player " + to_string(pid + 1) + " appears twice in team " + to_string(t + 1);
+                return false;
+            }
+            if (team_of[pid] != -1) {
+                error = "player " + to_string(pid + 1) + " is in teams " + to_string(team_of[pid] + 1) + " and " + to_string(t + 1);
+                return false;
+            }
+            team_of[pid] = t;
+            load += instance.players[pid].salary;
+        }
+        if (load > instance.B) {
+            error = "team " + to_string(t + 1) + " exceeds the budget";
+            return false;
+        }
+    }
+    for (int pid = 0; pid < instance.J; pid++) {
+        if (team_of[pid] == -1) {
+            error = "player " + to_string(pid + 1) + " has no team";
+            return false;
+        }
+        int clash = -1;
+        instance.adjacency->for_each_neighbor(pid, [&](int other) {
+            if (team_of[other] == team_of[pid]) clash = other;
+        });
+        if (clash != -1) {
+            error = "players " + to_string(pid + 1) + " and " + to_string(clash + 1) + " conflict in team " + to_string(team_of[pid] + 1);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Loads and validates a solution file.
+ * 
+ * @param filename The solution file.
+ * @param instance The problem instance the solution belongs to.
+ * 
+ * @return vector<Team> The solution read.
+ * @throws runtime_error If the file cannot be opened or the solution is not feasible.
+ */
+vector<Team> load_solution(const string &filename, const ProblemInstance &instance) {
+    ifstream in(filename);
+    if (!in.is_open()) {
+        throw runtime_error("Could not open file " + filename);
+    }
+    vector<Team> solution = read_solution(in, instance);
+    string error;
+    if (!validate_solution(solution, instance, error)) {
+        throw runtime_error("Invalid solution in " + filename + ": " + error);
+    }
+    return solution;
+}
+
+/**
+ * @brief Writes a file atomically (through a temporary file and a rename),
+ *        so a killed run never leaves a truncated file behind.
+ * 
+ * @param filename The file to write.
+ * @param write Function that writes the contents.
+ * 
+ * @return void
+ * @throws runtime_error If the file cannot be written.
+ */
+void write_file_atomically(const string &filename, const function<void(ostream &)> &write) {
+    const string tmp = filename + ".tmp";
+    {
+        ofstream out(tmp);
+        if (!out.is_open()) throw runtime_error("Could not open file " + tmp);
+        write(out);
+        if (!out) throw runtime_error("Could not write file " + tmp);
+    }
+    if (rename(tmp.c_str(), filename.c_str()) != 0) {
+        throw runtime_error("Could not rename " + tmp + " to " + filename);
+    }
+}
+
+struct Checkpoint {
+    int iterations = 0; // iterations done by the previous runs
+    int intermediate_solutions = 0; // improvements found by the previous runs
+    Rng rng;
+    vector<Team> best;
+    vector<Team> current;
+};
+
+/**
+ * @brief Saves the state of a run (incumbent, current solution, RNG and counters).
+ * 
+ * @param filename The checkpoint file.
+ * @param cp The state to save (solutions with original player ids).
+ * 
+ * @return void
+ */
+void save_checkpoint(const string &filename, const Checkpoint &cp) {
+    write_file_atomically(filename, [&](ostream &out) {
+        out << "ils_checkpoint 2\n";
+        out << "iterations " << cp.iterations << "\n";
+        out << "intermediate_solutions " << cp.intermediate_solutions << "\n";
+        out << "rng " << cp.rng << "\n";
+        out << "best ";
+        write_solution(out, cp.best);
+        out << "current ";
+        write_solution(out, cp.current);
+    });
+}
+
+/**
+ * @brief Loads a checkpoint written by save_checkpoint and validates its solutions.
+ * 
+ * @param filename The checkpoint file.
+ * @param instance The problem instance of the run.
+ * 
+ * @return Checkpoint The saved state.
+ * @throws runtime_error If the file cannot be opened, is malformed or holds an infeasible solution.
+ */
+Checkpoint load_checkpoint(const string &filename, const ProblemInstance &instance) {
+    ifstream in(filename);
+    if (!in.is_open()) {
+        throw runtime_error("Could not open file " + filename);
+    }
+    Checkpoint cp;
+    string key;
+    int version = 0;
+    in >> key >> version;
+    if (key != "ils_checkpoint") throw runtime_error("Not a checkpoint file: " + filename);
+    if (version != 2) throw runtime_error("Unsupported checkpoint version " + to_string(version) + " in " + filename);
+    in >> key >> cp.iterations >> key >> cp.intermediate_solutions >> key >> cp.rng;
+    in >> key;
+    cp.best = read_solution(in, instance);
+    in >> key;
+    cp.current = read_solution(in, instance);
+    if (!in) throw runtime_error("Malformed checkpoint: " + filename);
+
+    string error;
+    if (!validate_solution(cp.best, instance, error) || !validate_solution(cp.current, instance, error)) {
+        throw runtime_error("Invalid solution in " + filename + ": " + error);
+    }
+    return cp;
+}
+
+/**
+ * @brief Checks if a player can be added to a given team.
+ * 
+ * @param team The team to insert the player.
+ * @param player The player to be tested for insertion.
+ * @param engine The conflict engine of the instance (see with_conflict_engine).
+ * 
+ * @return true If the player can be added without exceeding budget or causing conflicts.
+ * @return false Otherwise.
+ */
+template <class Engine>
+bool can_add_to_team(const Team &team, const Player &player, const Engine &engine) {
+    if (player.salary > team.remaining_budget) return false;
+
+    // Check conflicts with players already in the team
+    for (int teammate_id : team.players) {
+        if (engine.conflict(player.id, teammate_id)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Same as above, dispatching to the conflict engine of the instance on every call
+ *        (for the phases outside the templated search kernels).
+ */
+bool can_add_to_team(const Team &team, const Player &player, const ProblemInstance &instance) {
+    return with_conflict_engine(instance, [&](const auto &engine) { return can_add_to_team(team, player, engine); });
+}
+
+/**
+ * @brief Sum of the squared team loads, in salary units (load = B - remaining_budget).
+ * 
+ * @details Secondary objective: with the same number of teams, a higher sum means the
+ *          slack is concentrated in fewer teams, which are the ones closest to being dissolved.
+ *          local_search keeps it up to date move by move (see local_search_step).
+ * 
+ * @param solution The solution.
+ * @param instance The problem instance with players and constraints.
+ * 
+ * @return long long The sum of the squared loads.
+ */
+long long squared_loads(const vector<Team> &solution, const ProblemInstance &instance) {
+    long long sum = 0;
+    for (const auto &team : solution) {
+        long long load = instance.B - team.remaining_budget;
+        sum += load * load;
+    }
+    return sum;
+}
+
+// Order in which construct_initial_solution places the players
+enum Constructor {
+    CONSTRUCT_FIRST_FIT,  // random order
+    CONSTRUCT_FFD,        // highest salary first
+    CONSTRUCT_DEGREE,     // most conflicts first
+    CONSTRUCTOR_COUNT
+};
+
+const char *constructor_name(Constructor constructor) {
+    static const char *names[] = {"first_fit", "ffd", "degree"};
+    return names[constructor];
+}
+
+/**
+ * @brief Parses the name of a constructor.
+ * 
+ * @param name "first_fit", "ffd" or "degree".
+ * 
+ * @return Constructor The constructor.
+ * @throws runtime_error If the name is unknown.
+ */
+Constructor parse_constructor(const string &name) {
+    for (int c = 0; c < CONSTRUCTOR_COUNT; c++) {
+        if (name == constructor_name((Constructor)c)) return (Constructor)c;
+    }
+    throw runtime_error("Unknown constructor: " + name);
+}
+
+/**
+ * @brief Constructs an initial solution using First Fit.
+ * 
+ * @details Players are shuffled, then (stable) sorted by the key of the constructor, so
+ *          ties stay in random order.
+ * 
+ * @param instance The problem instance with players and constraints.
+ * @param rng Random number generator for shuffling (advanced by the call).
+ * @param constructor Order in which the players are placed.
+ * 
+ * @return vector<Team> A set of initial teams with assigned players.
+ */
+vector<Team> construct_initial_solution(const ProblemInstance &instance, Rng &rng,
+                                        Constructor constructor = CONSTRUCT_FIRST_FIT) {
+
+    // Create a player ids list
+    vector<int> order(instance.J);
+    iota(order.begin(), order.end(), 0); 
+
+    // Shuffle players ids
+    std::shuffle(order.begin(), order.end(), rng);
+    if (constructor == CONSTRUCT_FFD) {
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return instance.players[a].salary > instance.players[b].salary;
+        });
+    } else if (constructor == CONSTRUCT_DEGREE) {
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return instance.adjacency->degree(a) > instance.adjacency->degree(b);
+        });
+    }
+
+    vector<Team> teams;
+
+    // Place players one by one (First Fit)
+    for (int pid : order) {
+        const Player &p = instance.players[pid];
+        bool placed = false;
+
+        // Try to put on the first viable team
+        for (auto &team : teams) {
+            if (can_add_to_team(team, p, instance)) {
+                team.players.push_back(p.id);
+                team.remaining_budget -= p.salary;
+                placed = true;
+                break;
+            }
+        }
+
+        // If doesnt fit on no one, create a new team
+        if (!placed) {
+            Team new_team;
+            new_team.remaining_budget = instance.B - p.salary;
+            new_team.players.push_back(p.id);
+            teams.push_back(move(new_team));
+        }
+    }
+
+    return teams;
+}
+
+// A neighbor of the local search: the players of one team moved to the other teams (see local_search_step)
+struct StepResult {
+    bool dissolved = false; // every player was moved
+    bool pruned = false; // the evaluation stopped because the score could not reach min_score
+    int score = 0; // number of players moved
+    int tried = 0; // players of the source team evaluated (all of them unless pruned)
+    long long gain = 0; // change of the sum of squared team loads (see squared_loads)
+    vector<pair<int,int>> moves; // (player, destination team), in the order of the source team
+    bool matched = false; // a matching was tried for the players First Fit left out (see match_left_out),
+                          // so the neighbor depends on more teams than the ones First Fit tried
+};
+
+constexpr int MATCHING_MAX_LEFT_OUT = 2; // players First Fit may leave out for the step to still try a matching
+constexpr int MATCHING_MAX_DEPTH = 3; // players moved again by one augmenting path
+constexpr int MATCHING_NODE_LIMIT = 64; // assignments tried by the fallback search
+
+/**
+ * @brief Completes a redistribution First Fit left incomplete, as an assignment of the players of
+ *        the source team to the other teams (capacity: their budget; no two conflicting players
+ *        in a team).
+ * 
+ * @details Every player left out looks for an augmenting path: a team that takes it, or one that
+ *          takes it once a player moved there in this step goes elsewhere, recursively, up to
+ *          MATCHING_MAX_DEPTH moves and visiting each team once (as in Kuhn's algorithm). If some
+ *          player has no such path but a swap could at least start one, a fallback search assigns
+ *          all the players again from scratch, highest salary first, backtracking over the teams
+ *          that take them, for at most MATCHING_NODE_LIMIT assignments. On failure the moves are
+ *          left as First Fit made them.
+ * 
+ * @param teams Current list of teams.
+ * @param instance The problem instance with players and constraints.
+ * @param source Index of the team being dissolved.
+ * @param engine The conflict engine of the instance (see with_conflict_engine).
+ * @param left_out Players of the source team First Fit could not move.
+ * @param extra_load Salary moved to each team by moves (updated with them).
+ * @param moves The moves of First Fit; on success, a move for every player of the source team.
+ * 
+ * @return true If every player has a destination.
+ */
+template <class Engine>
+bool match_left_out(const vector<Team> &teams, const ProblemInstance &instance, int source, const Engine &engine,
+                    const vector<int> &left_out, vector<int> &extra_load, vector<pair<int,int>> &moves) {
+    // Whether team t takes the player, ignoring the move at index skip (-1 = none)
+    auto takes = [&](int pid, int t, int skip) {
+        if (t == source) return false;
+        int room = teams[t].remaining_budget - extra_load[t] + (skip >= 0 ? instance.players[moves[skip].first].salary : 0);
+        if (instance.players[pid].salary > room || !can_add_to_team(teams[t], instance.players[pid], engine)) return false;
+        for (int m = 0; m < (int)moves.size(); m++) {
+            if (m != skip && moves[m].second == t && engine.conflict(pid, moves[m].first)) return false;
+        }
+        return true;
+    };
+    auto place = [&](int m, int pid, int t) {
+        if (m < (int)moves.size()) extra_load[moves[m].second] -= instance.players[moves[m].first].salary;
+        else moves.emplace_back();
+        moves[m] = {pid, t};
+        extra_load[t] += instance.players[pid].salary;
+    };
+
+    // A player left out has no direct destination; one displaced by a path looks for one first
+    vector<char> visited(teams.size());
+    bool swappable = false; // some team takes a player left out once a moved player leaves it
+    function<bool(int, int)> augment = [&](int pid, int depth) {
+        for (int t = 0; t < (int)teams.size() && depth < MATCHING_MAX_DEPTH; t++) {
+            if (takes(pid, t, -1)) {
+                place((int)moves.size(), pid, t);
+                return true;
+            }
+        }
+        if (depth == 0) return false;
+
+        // Only the teams that received players in this step can make room
+        for (int first = 0; first < (int)moves.size(); first++) {
+            int t = moves[first].second;
+            if (visited[t]) continue;
+            visited[t] = 1;
+            if (!can_add_to_team(teams[t], instance.players[pid], engine)) continue;
+            for (int m = first; m < (int)moves.size(); m++) {
+                if (moves[m].second != t || !takes(pid, t, m)) continue;
+                swappable |= depth == MATCHING_MAX_DEPTH;
+                int displaced = moves[m].first;
+                place(m, pid, t);
+                if (augment(displaced, depth - 1)) return true;
+                place(m, displaced, t);
+            }
+        }
+        return false;
+    };
+
+    vector<pair<int,int>> first_fit = moves;
+    bool complete = true;
+    for (int pid : left_out) {
+        fill(visited.begin(), visited.end(), 0);
+        if (!augment(pid, MATCHING_MAX_DEPTH)) {
+            complete = false;
+            break;
+        }
+    }
+    if (complete) return true;
+    if (!swappable) return false; // no swap makes room for a player left out (and no path was kept)
+
+    // Fallback: every player again, highest salary first
+    for (const auto &move : moves) extra_load[move.second] = 0;
+    moves.clear();
+    vector<int> order = teams[source].players;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return instance.players[a].salary > instance.players[b].salary;
+    });
+    int nodes = 0;
+    function<bool(size_t)> search = [&](size_t k) {
+        if (k == order.size()) return true;
+        for (int t = 0; t < (int)teams.size() && nodes < MATCHING_NODE_LIMIT; t++) {
+            if (!takes(order[k], t, -1)) continue;
+            nodes++;
+            place((int)moves.size(), order[k], t);
+            if (search(k + 1)) return true;
+            extra_load[t] -= instance.players[order[k]].salary;
+            moves.pop_back();
+        }
+        return false;
+    };
+    if (search(0)) return true;
+
+    moves = move(first_fit);
+    for (const auto &move : moves) extra_load[move.second] += instance.players[move.first].salary;
+    return false;
+}
+
+/**
+ * @brief Step in the neighborhood of the localsearch by attempting to dissolve a given team
+ *        and redistribute its players. The teams are not changed (see apply_step).
+ * 
+ * @details Every player goes to the first other team with room and no conflict, counting the
+ *          players already moved there in this step. With matching, if at most
+ *          MATCHING_MAX_LEFT_OUT players find no team, and only because of players moved before
+ *          them, the step tries to dissolve the team anyway by a matching (see match_left_out),
+ *          since an early player may have taken the only room of a later one.
+ *          Otherwise the evaluation stops as soon as the players moved plus the ones still to
+ *          try cannot reach min_score, since such a neighbor would never be selected.
+ * 
+ * @param teams Current list of teams.
+ * @param instance The problem instance with players and constraints.
+ * @param team_to_dissolve Index of the team selected to attempt dissolution.
+ * @param min_score Lowest score the caller can still select (-1 disables the pruning).
+ * @param engine The conflict engine of the instance (see with_conflict_engine).
+ * @param extra_load Scratch with one zero entry per team; it is zero again on return.
+ * @param result Output: the moves, the score (players moved) and the squared-load change.
+ * @param matching Whether players left out by First Fit are matched.
+ * 
+ * @return void
+ */
+template <class Engine>
+void local_search_step(const vector<Team> &teams, const ProblemInstance &instance, int team_to_dissolve, int min_score,
+                       const Engine &engine, vector<int> &extra_load, StepResult &result, bool matching = false) {
+    result.dissolved = false;
+    result.pruned = false;
+    result.score = 0;
+    result.tried = 0;
+    result.gain = 0;
+    result.moves.clear();
+    result.matched = false;
+
+    const Team &src_team = teams[team_to_dissolve];
+    if (teams.size() <= 1 || src_team.players.empty()) return;
+
+    int total_economy = 0; // Money saved from the source team from removing players
+    int left = (int)src_team.players.size(); // Players not tried yet
+    int left_out = 0; // Players with no destination
+    bool matchable = matching; // every player left out would fit some team if not for the moves of this step
+
+    // Try to move every player
+    for (int pid : src_team.players) {
+        left--;
+        const Player &p = instance.players[pid];
+        int target = -1;
+
+        for (int i = 0; i < (int)teams.size() && target == -1; i++) {
+            if (i == team_to_dissolve) continue; // skip own team
+            if (p.salary > teams[i].remaining_budget - extra_load[i]) continue;
+            if (!can_add_to_team(teams[i], p, engine)) continue;
+            target = i;
+            for (const auto &move : result.moves) { // players moved there in this step
+                if (move.second == i && engine.conflict(pid, move.first)) {
+                    target = -1;
+                    break;
+                }
+            }
+        }
+
+        if (target == -1) {
+            if (matchable) { // only a team that received players in this step can be kept from taking it
+                bool blocked = false;
+                for (const auto &move : result.moves) {
+                    if (can_add_to_team(teams[move.second], p, engine)) {
+                        blocked = true;
+                        break;
+                    }
+                }
+                matchable = blocked && ++left_out <= MATCHING_MAX_LEFT_OUT;
+            }
+            if (!matchable && result.score + left < min_score) {
+                result.pruned = true;
+                break;
+            }
+            continue;
+        }
+        long long load = instance.B - teams[target].remaining_budget + extra_load[target];
+        result.gain += (load + p.salary) * (load + p.salary) - load * load;
+        extra_load[target] += p.salary;
+        total_economy += p.salary;
+        result.moves.push_back({pid, target});
+        result.score++; //count everytime a player is moved
+    }
+    result.tried = (int)src_team.players.size() - left;
+
+    // Players left out by First Fit: try to dissolve the team by a matching
+    if (!result.pruned && left_out > 0 && matchable) {
+        vector<int> unplaced;
+        size_t next_move = 0;
+        for (int pid : src_team.players) {
+            if (next_move < result.moves.size() && result.moves[next_move].first == pid) next_move++;
+            else unplaced.push_back(pid);
+        }
+        result.matched = true;
+        if (match_left_out(teams, instance, team_to_dissolve, engine, unplaced, extra_load, result.moves)) {
+            result.score = (int)src_team.players.size();
+            result.gain = 0;
+            total_economy = 0;
+            for (const auto &move : result.moves) { // every destination once, with all it receives
+                total_economy += instance.players[move.first].salary;
+                long long load = instance.B - teams[move.second].remaining_budget;
+                long long extra = extra_load[move.second];
+                result.gain += (load + extra) * (load + extra) - load * load;
+                extra_load[move.second] = 0;
+            }
+        }
+    }
+    for (const auto &move : result.moves) extra_load[move.second] = 0;
+
+    // The source team loses the moved salaries
+    long long src_load = instance.B - src_team.remaining_budget;
+    result.gain += (src_load - total_economy) * (src_load - total_economy) - src_load * src_load;
+    result.dissolved = !result.pruned && result.score == (int)src_team.players.size();
+}
+
+/**
+ * @brief Walks to a neighbor evaluated by local_search_step.
+ * 
+ * @param teams Current list of teams, changed in place.
+ * @param instance The problem instance with players and constraints.
+ * @param team_to_dissolve Index of the team the neighbor was evaluated for.
+ * @param step The neighbor; if it dissolves the team, the team is erased.
+ * 
+ * @return void
+ */
+void apply_step(vector<Team> &teams, const ProblemInstance &instance, int team_to_dissolve, const StepResult &step) {
+    int total_economy = 0;
+    for (const auto &move : step.moves) {
+        int salary = instance.players[move.first].salary;
+        teams[move.second].players.push_back(move.first);
+        teams[move.second].remaining_budget -= salary;
+        total_economy += salary;
+    }
+
+    // If we moved everyone, delete the team (improvement)
+    if (step.dissolved) {
+        teams.erase(teams.begin() + team_to_dissolve);
+        return;
+    }
+
+    // Update the source team’s players (moves follow its order) and budget
+    Team &src_team = teams[team_to_dissolve];
+    size_t next_move = 0, kept = 0;
+    for (int pid : src_team.players) {
+        if (next_move < step.moves.size() && step.moves[next_move].first == pid) {
+            next_move++;
+        } else {
+            src_team.players[kept++] = pid;
+        }
+    }
+    src_team.players.resize(kept);
+    src_team.remaining_budget += total_economy;
+}
+
+/**
+ * @brief Updates the cached neighbors after a step walked by apply_step, dropping the ones it may have changed.
+ *
+ * @details The step only adds players to its destinations and removes players from its source,
+ *          and a cached neighbor is replayed player by player:
+ *           - a destination still rejects every player it rejected; a player it accepted is
+ *             still accepted if it fits the new budget (minus the players moved there before it)
+ *             and has no conflict with the players the step added;
+ *           - the source still accepts the players it accepted; a player it rejected may now
+ *             fit, unless it still exceeds the budget or conflicts with the team.
+ *          A neighbor is dropped if its own team was touched or if one of those checks fails,
+ *          and one whose matching failed (see match_left_out) also if the source now takes one
+ *          of its players, since the other teams only got fuller; otherwise its gain is corrected for the new loads of its destinations. A dissolved
+ *          source accepts no one: its entry is erased and the team indices of the remaining
+ *          entries are shifted as in apply_step.
+ *
+ * @param teams Current list of teams, after the step.
+ * @param instance The problem instance with players and constraints.
+ * @param engine The conflict engine of the instance (see with_conflict_engine).
+ * @param source Index of the team the step was evaluated for (before the step).
+ * @param step The step (its entry in cache, erased last if it dissolved the source).
+ * @param touched Sorted indices (before the step) of the source and destination teams of the step.
+ * @param cache Last neighbor evaluated for each team (see local_search_step).
+ * @param cached Whether each cache entry is still exact; cleared for the dropped ones.
+ *
+ * @return void
+ */
+template <class Engine>
+void update_cached_steps(const vector<Team> &teams, const ProblemInstance &instance, const Engine &engine, int source,
+                         const StepResult &step, const vector<int> &touched, vector<StepResult> &cache, vector<char> &cached) {
+    bool dissolved = step.dissolved;
+    auto team_at = [&](int t) -> const Team & { return teams[dissolved && t > source ? t - 1 : t]; };
+    auto was_touched = [&](int t) { return binary_search(touched.begin(), touched.end(), t); };
+
+    // Load change of every touched team
+    vector<long long> delta(touched.size(), 0);
+    for (const auto &move : step.moves) {
+        int salary = instance.players[move.first].salary;
+        delta[lower_bound(touched.begin(), touched.end(), move.second) - touched.begin()] += salary;
+        delta[lower_bound(touched.begin(), touched.end(), source) - touched.begin()] -= salary;
+    }
+
+    for (int t = 0; t < (int)cache.size(); t++) {
+        if (!cached[t]) continue;
+        StepResult &entry = cache[t];
+        bool valid = !was_touched(t) && !(entry.matched && entry.dissolved);
+        if (valid && entry.matched && !dissolved) {
+            for (int pid : team_at(t).players) {
+                if (can_add_to_team(teams[source], instance.players[pid], engine)) {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+        long long gain = entry.gain;
+
+        size_t next_move = 0;
+        for (int k = 0; valid && k < entry.tried; k++) {
+            int pid = team_at(t).players[k];
+            const Player &p = instance.players[pid];
+            int target = -1;
+            if (next_move < entry.moves.size() && entry.moves[next_move].first == pid) {
+                target = entry.moves[next_move++].second;
+            }
+
+            if (target != -1 && was_touched(target)) {
+                if (target == source && dissolved) {
+                    valid = false;
+                    break;
+                }
+                long long change = delta[lower_bound(touched.begin(), touched.end(), target) - touched.begin()];
+                gain += 2 * change * p.salary;
+                if (target == source) continue;
+
+                // The destination must still take the player, after the ones moved there before it
+                int extra = 0;
+                for (size_t m = 0; m + 1 < next_move; m++) {
+                    if (entry.moves[m].second == target) extra += instance.players[entry.moves[m].first].salary;
+                }
+                if (p.salary > team_at(target).remaining_budget - extra) valid = false;
+                for (const auto &move : step.moves) {
+                    if (valid && move.second == target && engine.conflict(pid, move.first)) valid = false;
+                }
+            }
+
+            // Players that tried the source team before their destination (or found none)
+            if (!valid || dissolved || (target != -1 && target < source)) continue;
+            if (can_add_to_team(teams[source], p, engine)) valid = false;
+        }
+
+        if (valid) {
+            entry.gain = gain;
+        } else {
+            cached[t] = 0;
+        }
+    }
+
+    if (dissolved) {
+        cache.erase(cache.begin() + source);
+        cached.erase(cached.begin() + source);
+        for (int t = 0; t < (int)cache.size(); t++) {
+            if (!cached[t]) continue;
+            for (auto &move : cache[t].moves) {
+                if (move.second > source) move.second--;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Executes a local search to improve the solution.
+ * 
+ * @details The neighborhood behavior is the following:
+ *  1. For each team, generate a neighbor by exploding that team. Teams are tried by priority
+ *     (fewest players, then lowest load, then fewest conflicts), kept in an ordered set that
+ *     is only updated for the teams touched by each step.
+ *  2. If this neighbor dissolves the team, immediately select it and stop checking further teams.
+ *  3. Otherwise, if the neighbor’s score (`neighbor_score`) is better than `last_score`,
+ *     immediately select it and stop checking further teams.
+ *  4. If no neighbor improves upon `last_score`, choose the neighbor with the highest score
+ *     among all teams. Neighbors that can no longer reach that score are abandoned midway.
+ *  5. If after stagnation_limit iterations no best_score is found nor team is dissolved, the search stops.
+ *  6. The deadline is polled once per neighbor evaluation; when it is reached the search
+ *     stops at once, without walking to the neighbor selected so far.
+ *  7. Neighbors are cached per team and only evaluated again when a step changes a team they
+ *     depend on (see update_cached_steps), so the selection is the same as without the cache.
+ *  8. With matching, the players First Fit leaves out are matched (see local_search_step) only
+ *     once the plain steps stagnate: the teams are evaluated once more with matching, and the
+ *     search stops unless that dissolves a team, after which it returns to the plain steps.
+ * @param initial The starting solution (vector of teams).
+ * @param instance The problem instance with players and constraints.
+ * @param engine The conflict engine of the instance (see with_conflict_engine).
+ * @param deadline Time limit of the search.
+ * @param stagnation_limit Iterations without improvement before the search stops.
+ * @param matching Whether the search retries matching the players First Fit leaves out on stagnation.
+ * 
+ * @return vector<Team> The best solution found by local search.
+ */
+template <class Engine>
+vector<Team> local_search(vector<Team> initial, const ProblemInstance &instance, const Engine &engine, Deadline &deadline,
+                          int stagnation_limit, bool matching) {
+    vector<Team> best_solution = initial;
+    vector<Team> current_solution = move(initial); // This will be current node on the neighbors graph
+    int iterations_without_improvement=0; //Stop if nothing gets better after X iterations
+    int last_score=0; // This will be the score of the last step on the graph
+                     // It will be used to check if found a best score than the last one
+    int best_score=0; // This will be the highest score since the last dissolution
+    long long current_squared = squared_loads(current_solution, instance); // Secondary objective, kept incrementally
+    long long best_squared = current_squared;
+
+    // Priority of the teams to dissolve: (players, load, conflicts, index)
+    using TeamKey = tuple<int, int, long long, int>;
+    set<TeamKey> order;
+    vector<TeamKey> key_of;
+    auto team_key = [&](int t) {
+        const Team &team = current_solution[t];
+        long long conflicts = 0;
+        for (int pid : team.players) conflicts += instance.adjacency->degree(pid);
+        return TeamKey{(int)team.players.size(), instance.B - team.remaining_budget, conflicts, t};
+    };
+    auto rebuild_order = [&]() {
+        order.clear();
+        key_of.resize(current_solution.size());
+        for (int t = 0; t < (int)current_solution.size(); t++) {
+            key_of[t] = team_key(t);
+            order.insert(key_of[t]);
+        }
+    };
+    rebuild_order();
+
+    vector<int> extra_load(current_solution.size(), 0);
+    vector<StepResult> cache(current_solution.size()); // Last neighbor evaluated for each team
+    vector<char> cached(current_solution.size(), 0);
+    vector<int> touched;
+    bool matching_phase = false; // steps match left-out players only after the plain steps stagnate
+    // Best score an abandoned neighbor could still reach (the players moved plus the ones not tried)
+    auto cached_bound = [&](int t) {
+        return cache[t].score + (int)current_solution[t].players.size() - cache[t].tried;
+    };
+    while(true) {
+        int current_best_score=-1; // The scores of the neighbors (best will be chosen for each step)
+        long long current_best_gain=0;
+        iterations_without_improvement++;
+        int team_exploded_idx = -1;
+
+        // EACH ITERATION: node of solutions graph
+
+        // For every available team, considering stepping to its direction
+        // Graph step: choose this team to dissolve
+        bool dissolved = false;
+        for (const TeamKey &key : order) {
+            if (deadline.expired()) break;
+            int team_idx = get<3>(key);
+
+            // Get neighbor for testing score (abandoned if it cannot reach current_best_score).
+            // A cached neighbor is still exact; a cached abandoned one is skipped if its bound is still too low
+            StepResult &neighbor = cache[team_idx];
+            if (!cached[team_idx] || (neighbor.pruned && cached_bound(team_idx) >= current_best_score)) {
+                local_search_step(current_solution, instance, team_idx, current_best_score, engine, extra_load, neighbor,
+                                  matching_phase);
+                cached[team_idx] = 1;
+            }
+            if (neighbor.pruned) continue;
+
+            if (neighbor.dissolved) {
+                // If the team was successfully removed (rare), choose this and stop looking for other neighbors
+                dissolved = true;
+                team_exploded_idx=team_idx;
+                iterations_without_improvement=0;
+                best_score=0; // best_score is reset
+                break; //go to next iteration
+            }
+
+            // First FIT (if neighbor score is better than the last score)
+            if(neighbor.score > last_score){
+                team_exploded_idx=team_idx;
+                if(neighbor.score>best_score){
+                    best_score=neighbor.score; // keep track if it improves
+                    iterations_without_improvement=0;
+                }
+                break;
+            }
+
+            // If no neighbor has a better score than the last node
+            // Use the best among the neighbors (ties go to the more unbalanced loads)
+            if(neighbor.score>current_best_score || (neighbor.score==current_best_score && neighbor.gain>current_best_gain)){
+                current_best_score=neighbor.score;
+                current_best_gain=neighbor.gain;
+                team_exploded_idx=team_idx;
+                // iterations_without_improvement ISNT reset
+            }
+        }
+        if (team_exploded_idx == -1 || deadline.reached) break; // no team to explode, or out of time
+        if (matching_phase && !dissolved) break; // not even a matching dissolves a team
+
+        // WALK on the solutions graph
+        const StepResult &target_neighbor = cache[team_exploded_idx];
+        int moved = target_neighbor.score;
+        apply_step(current_solution, instance, team_exploded_idx, target_neighbor);
+        last_score=dissolved ? 0 : target_neighbor.score;
+        current_squared+=target_neighbor.gain;
+
+        // Only the source and the destination teams change
+        touched.assign(1, team_exploded_idx);
+        for (const auto &move : target_neighbor.moves) touched.push_back(move.second);
+        sort(touched.begin(), touched.end());
+        touched.erase(unique(touched.begin(), touched.end()), touched.end());
+        update_cached_steps(current_solution, instance, engine, team_exploded_idx, target_neighbor, touched, cache, cached);
+
+        if (dissolved) {
+            best_solution=current_solution; //Only update the best solution output when a team is dissolved (-1 total teams)
+            best_squared=current_squared;
+            rebuild_order();
+            if (matching_phase) {
+                // Back to the plain (cheaper) steps; the cached neighbors were matched
+                matching_phase = false;
+                fill(cached.begin(), cached.end(), 0);
+            }
+        } else {
+            // Same number of teams but emptier small teams: keep it as output (the counter is not reset)
+            if(current_solution.size()==best_solution.size() && current_squared>best_squared){
+                best_solution=current_solution;
+                best_squared=current_squared;
+            }
+
+            // Only the touched teams change priority
+            for (int t : touched) {
+                order.erase(key_of[t]);
+                key_of[t] = team_key(t);
+                order.insert(key_of[t]);
+            }
+        }
+
+        // Logs each step
+        if(dissolved){
+            LOG(LOG_TRACE, "Succesffuly dissolved team number " << team_exploded_idx+1 << " moving " << moved << " (all) players. \n"
+                        << "New solution has " << current_solution.size() << " teams. \n");
+        }else{
+            LOG(LOG_TRACE, "Exploded team number " << team_exploded_idx+1 << " moving " << moved << " players. \n");
+        }
+
+        if(iterations_without_improvement>stagnation_limit) {
+            // After trying a lot and not dissolving any team, stop local search
+            if (!matching || matching_phase) break;
+            // With matching, first sweep the teams once more matching the left-out players
+            matching_phase = true;
+            iterations_without_improvement = 0;
+            fill(cached.begin(), cached.end(), 0);
+        }
+
+    }
+
+    return best_solution;
+    
+}
+
+/**
+ * @brief Executes a local search with the conflict engine of the size class of the instance.
+ * 
+ * @param initial The starting solution (vector of teams).
+ * @param instance The problem instance with players and constraints.
+ * @param deadline Time limit of the search.
+ * @param stagnation_limit Iterations without improvement before the search stops.
+ * @param matching Whether the search retries matching the players First Fit leaves out on stagnation.
+ * 
+ * @return vector<Team> The best solution found by local search.
+ */
+vector<Team> local_search(vector<Team> initial, const ProblemInstance &instance, Deadline &deadline,
+                          int stagnation_limit = DEFAULT_STAGNATION_LIMIT, bool matching = false) {
+    return with_conflict_engine(instance, [&](const auto &engine) {
+        return local_search(move(initial), instance, engine, deadline, stagnation_limit, matching);
+    });
+}
+
+/**
+ * @brief Applies a perturbation to the current solution by moving a random percentage 
+ *        of players to new teams, creating new teams if moving fails.
+ * 
+ * @details Costs O(T + k log k + k * placement) for k moved players and T teams:
+ *          1. Players are addressed by their slot in the concatenation of the teams
+ *             (prefix sums of the team sizes), and k slots are drawn by a partial
+ *             Fisher–Yates shuffle over that virtual array (only touched slots are stored).
+ *          2. Chosen players are swap-removed from their teams, highest slot first so that
+ *             pending positions stay valid, and the team budgets are updated in place.
+ *          3. They are reinserted by First Fit in the order they were drawn.
+ *          4. Teams left empty are dropped, so the teams after them shift down; the callers
+ *             (ils_search, run_benchmark) keep no team indices across the call. Leaving them
+ *             to the local search would not work: local_search_step never dissolves an
+ *             empty team, and it would be counted in the result.
+ *          Past the deadline nothing is moved; if it is reached during the reinsertion, the
+ *          players not reinserted yet get teams of their own, which keeps the solution valid.
+ * 
+ * @param solution Current solution (pass with move() to avoid a copy).
+ * @param rng Random number generator for selecting players to move.
+ * @param instance The original problem instance with players and constraints.
+ * @param perturbation_ratio The percentage of players to perturb (0.0–1.0).
+ * @param deadline Time limit of the search.
+ * 
+ * @return vector<Team> The perturbed solution after reassignments.
+ */
+vector<Team> perturbation(vector<Team> solution, Rng &rng, const ProblemInstance &instance, double perturbation_ratio,
+                          Deadline &deadline) {
+    // Slot offsets of each team
+    int T = (int)solution.size();
+    vector<int> offset(T + 1, 0);
+    for (int tid = 0; tid < T; tid++) offset[tid + 1] = offset[tid] + (int)solution[tid].players.size();
+    int total = offset[T];
+
+    if (total == 0 || deadline.expired_now()) return solution;
+
+    // Determine how many players to move, ranging from [1, total]
+    size_t proposed = static_cast<size_t>(total * perturbation_ratio);
+    int num_to_move = (int)std::max<size_t>(1, std::min<size_t>(total, proposed));
+
+    // Partial Fisher–Yates: chosen[i] is the slot at position i after i swaps
+    unordered_map<int,int> moved_slots; // virtual array entries that differ from identity
+    moved_slots.reserve(2 * num_to_move);
+    auto slot_at = [&](int i) {
+        auto it = moved_slots.find(i);
+        return it == moved_slots.end() ? i : it->second;
+    };
+    vector<int> chosen(num_to_move);
+    for (int i = 0; i < num_to_move; i++) {
+        int j = i + (int)rng.below(total - i);
+        int slot_j = slot_at(j);
+        moved_slots[j] = slot_at(i);
+        chosen[i] = slot_j;
+    }
+
+    // Resolve slots to players before any removal
+    vector<int> chosen_players(num_to_move);
+    vector<int> by_slot = chosen;
+    sort(by_slot.begin(), by_slot.end(), greater<int>());
+    for (int i = 0; i < num_to_move; i++) {
+        int slot = chosen[i];
+        int tid = (int)(upper_bound(offset.begin(), offset.end(), slot) - offset.begin()) - 1;
+        chosen_players[i] = solution[tid].players[slot - offset[tid]];
+    }
+
+    // Remove chosen players from their teams (swap with the last player, O(1) each)
+    for (int slot : by_slot) {
+        int tid = (int)(upper_bound(offset.begin(), offset.end(), slot) - offset.begin()) - 1;
+        auto &team = solution[tid];
+        int pos = slot - offset[tid];
+        team.remaining_budget += instance.players[team.players[pos]].salary;
+        team.players[pos] = team.players.back();
+        team.players.pop_back();
+    }
+
+    // Try to reassign each chosen player
+    for (int pid : chosen_players) {
+        const Player &p = instance.players[pid];
+        bool placed = false;
+        bool out_of_time = deadline.expired();
+
+        for (auto &team : solution) {
+            if (out_of_time) break;
+            if (can_add_to_team(team, p, instance)) {
+                team.players.push_back(pid);
+                team.remaining_budget -= p.salary;
+                placed = true;
+                break;
+            }
+        }
+
+        // If no team can fit (or there is no time left), create a new one
+        if (!placed) {
+            Team new_team;
+            new_team.remaining_budget = instance.B - p.salary;
+            new_team.players.push_back(pid);
+            solution.push_back(move(new_team));
+        }
+    }
+
+    // Drop teams left empty (indices of the later teams change, see step 4)
+    solution.erase(remove_if(solution.begin(), solution.end(),
+                             [](const Team &team) { return team.players.empty(); }),
+                   solution.end());
+
+    return solution;
+}
+
+
+// ================= Exact Repacking ================= //
+constexpr int EXACT_MIN_TEAMS = 3; // teams pooled by one exact repacking
+constexpr int EXACT_MAX_TEAMS = 5;
+constexpr int EXACT_ATTEMPTS = 10; // subproblems tried per round (see IlsParams::exact_interval)
+
+/**
+ * @brief Packs the given players into at most `teams` teams, exactly, by depth-first branch and bound.
+ * 
+ * @details Players are placed by decreasing salary. Each one goes into an open team or opens
+ *          the next one (empty teams are interchangeable, so only one is tried). A branch is cut
+ *          when the room left in the teams that can still take the cheapest remaining player is
+ *          smaller than the remaining salaries. The search gives up after node_limit nodes or
+ *          at the deadline.
+ * 
+ * @param players The players to pack.
+ * @param teams Number of teams available.
+ * @param instance The problem instance with players and constraints.
+ * @param engine The conflict engine of the instance (see with_conflict_engine).
+ * @param node_limit Maximum number of search nodes.
+ * @param deadline Time limit of the search.
+ * @param packing Output: the players of each team (some may be empty) if a packing was found.
+ * 
+ * @return true If the players fit in the teams.
+ */
+template <class Engine>
+bool pack_exactly(vector<int> players, int teams, const ProblemInstance &instance, const Engine &engine,
+                  long long node_limit, Deadline &deadline, vector<vector<int>> &packing) {
+    stable_sort(players.begin(), players.end(), [&](int a, int b) {
+        return instance.players[a].salary > instance.players[b].salary;
+    });
+    size_t n = players.size();
+    vector<long long> remaining(n + 1, 0); // salaries of players[i..]
+    int large = 0; // players that cannot share a team with each other (salary > B / 2)
+    for (size_t i = n; i-- > 0;) {
+        int salary = instance.players[players[i]].salary;
+        remaining[i] = remaining[i + 1] + salary;
+        large += 2 * salary > instance.B;
+    }
+    if (remaining[0] > (long long)teams * instance.B || large > teams) return false;
+    int cheapest = n ? instance.players[players.back()].salary : 0;
+
+    packing.assign(teams, {});
+    vector<int> load(teams, 0);
+    int open = 0;
+    long long nodes = 0;
+    auto place = [&](auto &self, size_t next) -> bool {
+        if (next == n) return true;
+        if (++nodes > node_limit || deadline.expired()) return false;
+
+        long long room = 0;
+        for (int t = 0; t < teams; t++) {
+            if (instance.B - load[t] >= cheapest) room += instance.B - load[t];
+        }
+        if (room < remaining[next]) return false;
+
+        int pid = players[next];
+        int salary = instance.players[pid].salary;
+        for (int t = 0; t < min(open + 1, teams); t++) {
+            if (load[t] + salary > instance.B) continue;
+            bool compatible = true;
+            for (int other : packing[t]) {
+                if (engine.conflict(pid, other)) { compatible = false; break; }
+            }
+            if (!compatible) continue;
+
+            bool opened = t == open;
+            open += opened;
+            packing[t].push_back(pid);
+            load[t] += salary;
+            if (self(self, next + 1)) return true;
+            packing[t].pop_back();
+            load[t] -= salary;
+            open -= opened;
+            if (nodes > node_limit || deadline.reached) return false;
+        }
+        return false;
+    };
+    return place(place, 0);
+}
+
+/**
+ * @brief Exact LNS move: pools the players of a few related teams and repacks them exactly
+ *        into one team less.
+ * 
+ * @details Between EXACT_MIN_TEAMS and EXACT_MAX_TEAMS (k) teams are chosen: a random one
+ *          among the k least loaded, then, among the 4k least loaded teams, the ones with the
+ *          most conflicts with the players already pooled (ties: lowest load). Teams whose
+ *          players conflict are the ones random moves rarely untangle. Players with salary
+ *          above B / 2 need a team each, so teams that would bring the pool to k of them are
+ *          not candidates.
+ *          The pooled players are given to pack_exactly; if they fit, the chosen teams are
+ *          replaced by the new ones.
+ * 
+ * @param solution Current solution, changed in place on success.
+ * @param instance The problem instance with players and constraints.
+ * @param rng Random number generator.
+ * @param node_limit Node limit of the branch and bound.
+ * @param deadline Time limit of the search.
+ * 
+ * @return true If a team was removed.
+ */
+bool exact_repack(vector<Team> &solution, const ProblemInstance &instance, Rng &rng, long long node_limit,
+                  Deadline &deadline) {
+    int T = (int)solution.size();
+    if (T < EXACT_MIN_TEAMS) return false;
+    int k = min(T, EXACT_MIN_TEAMS + (int)rng.below(EXACT_MAX_TEAMS - EXACT_MIN_TEAMS + 1));
+
+    // Teams by load (random order among equal loads)
+    vector<int> by_load(T);
+    iota(by_load.begin(), by_load.end(), 0);
+    shuffle(by_load.begin(), by_load.end(), rng);
+    stable_sort(by_load.begin(), by_load.end(), [&](int a, int b) {
+        return solution[a].remaining_budget > solution[b].remaining_budget;
+    });
+    auto large_players = [&](int t) { // players with salary above B / 2
+        int count = 0;
+        for (int pid : solution[t].players) count += 2 * instance.players[pid].salary > instance.B;
+        return count;
+    };
+
+    // Candidates: the seed, then the 4k least loaded teams that could join it
+    vector<int> order = {by_load[rng.below(k)]};
+    vector<int> large = {large_players(order[0])};
+    for (int t : by_load) {
+        if ((int)order.size() > 4 * k) break;
+        int count = large_players(t);
+        if (t == order[0] || large[0] + count >= k) continue;
+        order.push_back(t);
+        large.push_back(count);
+    }
+    int candidates = (int)order.size();
+    if (candidates < k) return false;
+    unordered_map<int,int> candidate_of; // player -> position in order
+    for (int c = 0; c < candidates; c++) {
+        for (int pid : solution[order[c]].players) candidate_of[pid] = c;
+    }
+
+    vector<int> shared(candidates, 0);
+    vector<char> chosen(candidates, 0);
+    vector<int> players;
+    int pooled_large = 0;
+    auto choose = [&](int c) {
+        chosen[c] = 1;
+        pooled_large += large[c];
+        for (int pid : solution[order[c]].players) {
+            players.push_back(pid);
+            instance.adjacency->for_each_neighbor(pid, [&](int other) {
+                auto it = candidate_of.find(other);
+                if (it != candidate_of.end()) shared[it->second]++;
+            });
+        }
+    };
+    choose(0);
+    for (int picked = 1; picked < k; picked++) {
+        int best = -1;
+        for (int c = 1; c < candidates; c++) {
+            if (chosen[c] || pooled_large + large[c] >= k) continue;
+            if (best == -1 || shared[c] > shared[best]) best = c; // order is by load
+        }
+        if (best == -1) return false;
+        choose(best);
+    }
+
+    vector<vector<int>> packing;
+    bool packed = with_conflict_engine(instance, [&](const auto &engine) {
+        return pack_exactly(players, k - 1, instance, engine, node_limit, deadline, packing);
+    });
+    if (!packed) return false;
+
+    // Replace the chosen teams (highest index first) by the packing
+    vector<int> removed;
+    for (int c = 0; c < candidates; c++) {
+        if (chosen[c]) removed.push_back(order[c]);
+    }
+    sort(removed.begin(), removed.end(), greater<int>());
+    for (int t : removed) solution.erase(solution.begin() + t);
+    for (auto &team_players : packing) {
+        if (team_players.empty()) continue;
+        Team team;
+        team.remaining_budget = instance.B;
+        for (int pid : team_players) team.remaining_budget -= instance.players[pid].salary;
+        team.players = move(team_players);
+        solution.push_back(move(team));
+    }
+    LOG(LOG_DEBUG, "Exact repacking moved " << players.size() << " players of " << k << " teams into "
+         << k - 1 << " teams.\n");
+    return true;
+}
+
+// ================= Team Pool ================= //
+struct PooledTeam {
+    int load; // salary used by the team
+    vector<int> players; // sorted player ids
+};
+
+struct TeamPool {
+    size_t capacity = 2000; // max number of teams kept
+    vector<PooledTeam> teams;
+    unordered_map<uint64_t, int> index; // membership hash -> position in teams
+};
+
+/**
+ * @brief Hashes a team membership (FNV-1a over the sorted player ids).
+ * 
+ * @param sorted_players Player ids of the team, in increasing order.
+ * 
+ * @return uint64_t The membership hash.
+ */
+uint64_t hash_membership(const vector<int> &sorted_players) {
+    uint64_t h = 1469598103934665603ULL;
+    for (int pid : sorted_players) {
+        h ^= (uint64_t)(uint32_t)pid;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief Rebuilds the hash index of the pool after its teams vector was reordered.
+ * 
+ * @param pool The team pool.
+ * 
+ * @return void
+ */
+void rebuild_pool_index(TeamPool &pool) {
+    pool.index.clear();
+    for (int i = 0; i < (int)pool.teams.size(); i++) {
+        pool.index[hash_membership(pool.teams[i].players)] = i;
+    }
+}
+
+/**
+ * @brief Adds the distinct high-load teams of a solution to the pool.
+ * 
+ * @details A team is harvested when its load is at least the average load of the solution.
+ *          Teams already in the pool (same sorted membership) are skipped. When the pool
+ *          grows past its capacity, only the fullest 3/4 of it is kept.
+ * 
+ * @param pool The team pool.
+ * @param solution Solution whose teams are harvested.
+ * @param instance The problem instance with players and constraints.
+ * 
+ * @return void
+ */
+void harvest_teams(TeamPool &pool, const vector<Team> &solution, const ProblemInstance &instance) {
+    if (solution.empty()) return;
+
+    long long total_load = 0;
+    for (const auto &team : solution) total_load += instance.B - team.remaining_budget;
+    double mean_load = (double)total_load / solution.size();
+
+    for (const auto &team : solution) {
+        int load = instance.B - team.remaining_budget;
+        if (load < mean_load || team.players.empty()) continue;
+
+        vector<int> members = team.players;
+        sort(members.begin(), members.end());
+        uint64_t h = hash_membership(members);
+
+        // Same hash means same team (a real collision only costs us one pool entry)
+        if (pool.index.count(h)) continue;
+
+        pool.index[h] = (int)pool.teams.size();
+        pool.teams.push_back({load, move(members)});
+    }
+
+    if (pool.teams.size() > pool.capacity) {
+        stable_sort(pool.teams.begin(), pool.teams.end(),
+                    [](const PooledTeam &a, const PooledTeam &b) { return a.load > b.load; });
+        pool.teams.resize(pool.capacity * 3 / 4);
+        rebuild_pool_index(pool);
+    }
+}
+
+/**
+ * @brief Recombines the pooled teams into a full solution by approximately solving
+ *        a set-partitioning problem over the pool.
+ * 
+ * @details 1. Greedy: visit the pooled teams from the fullest to the emptiest (ties broken
+ *             randomly) and select every team disjoint from the ones already selected.
+ *          2. Local improvement: an unselected team that overlaps exactly one selected team
+ *             replaces it when it carries more load; freed players are then offered to the
+ *             remaining disjoint teams. Repeats until no swap improves the covered load.
+ *          3. Repair: players not covered by the selected teams are placed by First Fit
+ *             (highest salary first), opening new teams if needed.
+ * 
+ * @param pool The team pool.
+ * @param instance The problem instance with players and constraints.
+ * @param rng Random number generator for breaking ties between equally loaded teams.
+ * 
+ * @return vector<Team> A complete feasible solution.
+ */
+vector<Team> recombine_pool(const TeamPool &pool, const ProblemInstance &instance, Rng &rng) {
+    int P = (int)pool.teams.size();
+
+    vector<int> order(P);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), rng);
+    stable_sort(order.begin(), order.end(),
+                [&](int a, int b) { return pool.teams[a].load > pool.teams[b].load; });
+
+    vector<int> owner(instance.J, -1); // selected pool team covering each player
+    vector<char> selected(P, 0);
+
+    auto is_free = [&](int t) {
+        for (int pid : pool.teams[t].players) {
+            if (owner[pid] != -1) return false;
+        }
+        return true;
+    };
+    auto select = [&](int t) {
+        selected[t] = 1;
+        for (int pid : pool.teams[t].players) owner[pid] = t;
+    };
+    auto unselect = [&](int t) {
+        selected[t] = 0;
+        for (int pid : pool.teams[t].players) owner[pid] = -1;
+    };
+    auto fill = [&]() {
+        for (int t : order) {
+            if (!selected[t] && is_free(t)) select(t);
+        }
+    };
+
+    // Greedy
+    fill();
+
+    // Local improvement (1-for-1 swaps that increase the covered load)
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (int u : order) {
+            if (selected[u]) continue;
+
+            int blocker = -1;
+            bool single_blocker = true;
+            for (int pid : pool.teams[u].players) {
+                int s = owner[pid];
+                if (s == -1 || s == blocker) continue;
+                if (blocker != -1) { single_blocker = false; break; }
+                blocker = s;
+            }
+            if (!single_blocker || blocker == -1) continue;
+
+            if (pool.teams[u].load > pool.teams[blocker].load) {
+                unselect(blocker);
+                select(u);
+                improved = true;
+            }
+        }
+        if (improved) fill();
+    }
+
+    // Build the solution from the selected teams
+    vector<Team> solution;
+    for (int t = 0; t < P; t++) {
+        if (!selected[t]) continue;
+        Team team;
+        team.remaining_budget = instance.B - pool.teams[t].load;
+        team.players = pool.teams[t].players;
+        solution.push_back(move(team));
+    }
+
+    // Repair: place uncovered players
+    vector<int> uncovered;
+    for (int pid = 0; pid < instance.J; pid++) {
+        if (owner[pid] == -1) uncovered.push_back(pid);
+    }
+    stable_sort(uncovered.begin(), uncovered.end(), [&](int a, int b) {
+        return instance.players[a].salary > instance.players[b].salary;
+    });
+    for (int pid : uncovered) {
+        const Player &p = instance.players[pid];
+        bool placed = false;
+        for (auto &team : solution) {
+            if (can_add_to_team(team, p, instance)) {
+                team.players.push_back(pid);
+                team.remaining_budget -= p.salary;
+                placed = true;
+                break;
+            }
+        }
+        if (!placed) {
+            Team new_team;
+            new_team.remaining_budget = instance.B - p.salary;
+            new_team.players.push_back(pid);
+            solution.push_back(move(new_team));
+        }
+    }
+
+    return solution;
+}
+
+
+// ================= Adaptive Large Neighborhood Search ================= //
+enum RuinOperator {
+    RUIN_RANDOM,             // uniformly random players (same choice as perturbation)
+    RUIN_LEAST_LOADED,       // every player of the least loaded teams
+    RUIN_CONFLICT_NEIGHBORS, // a random team and the teams holding its players' conflicts
+    RUIN_HIGHEST_SALARY,     // the highest salaries (with noise)
+    RUIN_COUNT
+};
+
+enum RecreateOperator {
+    RECREATE_FIRST_FIT,      // random order, first team that accepts
+    RECREATE_BEST_FIT,       // highest salary first, team left with the least budget
+    RECREATE_CONFLICT_DEGREE,// most conflicted first, first team that accepts
+    RECREATE_COUNT
+};
+
+const char *RUIN_NAMES[] = {"random", "least_loaded", "conflict_neighbors", "highest_salary"};
+const char *RECREATE_NAMES[] = {"first_fit", "best_fit", "conflict_degree"};
+
+struct AlnsState {
+    double ruin_weight[RUIN_COUNT] = {1, 1, 1, 1};
+    double recreate_weight[RECREATE_COUNT] = {1, 1, 1};
+    double ruin_score[RUIN_COUNT] = {};
+    double recreate_score[RECREATE_COUNT] = {};
+    int ruin_uses[RUIN_COUNT] = {};
+    int recreate_uses[RECREATE_COUNT] = {};
+    int last_ruin = -1; // operators used by the last perturbation
+    int last_recreate = -1;
+    int segment_iterations = 0;
+
+    static constexpr int SEGMENT = 50; // iterations between weight updates
+    static constexpr double REACTION = 0.1; // how fast weights follow the scores
+    static constexpr double SCORE_BEST = 33; // the operators led to a new best solution
+    static constexpr double SCORE_BETTER = 9; // ... to fewer teams than before them
+    static constexpr double SCORE_EQUAL = 3; // ... to as many teams as before them
+};
+
+/**
+ * @brief Roulette-wheel selection.
+ * 
+ * @param weights Operator weights.
+ * @param count Number of operators.
+ * @param rng Random number generator.
+ * 
+ * @return int Index of the selected operator.
+ */
+int roulette(const double *weights, int count, Rng &rng) {
+    double total = 0;
+    for (int i = 0; i < count; i++) total += weights[i];
+    double r = uniform_real_distribution<double>(0, total)(rng);
+    for (int i = 0; i < count; i++) {
+        if (r < weights[i]) return i;
+        r -= weights[i];
+    }
+    return count - 1;
+}
+
+/**
+ * @brief Credits the operators of the last perturbation and, at the end of each segment,
+ *        moves every weight towards the average score of its operator.
+ * 
+ * @param state The ALNS state.
+ * @param score Score earned by the last perturbation (0 when it led to more teams).
+ * 
+ * @return void
+ */
+void alns_update(AlnsState &state, double score) {
+    if (state.last_ruin < 0) return;
+    state.ruin_score[state.last_ruin] += score;
+    state.ruin_uses[state.last_ruin]++;
+    state.recreate_score[state.last_recreate] += score;
+    state.recreate_uses[state.last_recreate]++;
+
+    if (++state.segment_iterations < AlnsState::SEGMENT) return;
+    state.segment_iterations = 0;
+
+    auto update = [](double *weight, double *score_sum, int *uses, int count) {
+        for (int i = 0; i < count; i++) {
+            if (uses[i] > 0) {
+                weight[i] = (1 - AlnsState::REACTION) * weight[i] + AlnsState::REACTION * score_sum[i] / uses[i];
+            }
+            weight[i] = max(weight[i], 0.05); // every operator keeps a chance
+            score_sum[i] = 0;
+            uses[i] = 0;
+        }
+    };
+    update(state.ruin_weight, state.ruin_score, state.ruin_uses, RUIN_COUNT);
+    update(state.recreate_weight, state.recreate_score, state.recreate_uses, RECREATE_COUNT);
+
+    ostringstream weights;
+    for (int i = 0; i < RUIN_COUNT; i++) weights << " " << RUIN_NAMES[i] << "=" << state.ruin_weight[i];
+    for (int i = 0; i < RECREATE_COUNT; i++) weights << " " << RECREATE_NAMES[i] << "=" << state.recreate_weight[i];
+    LOG(LOG_DEBUG, "ALNS weights:" << weights.str() << "\n");
+}
+
+/**
+ * @brief Chooses the players removed by a ruin operator.
+ * 
+ * @param op The ruin operator.
+ * @param solution Current solution.
+ * @param instance The problem instance with players and constraints.
+ * @param ratio Size of the ruin: share of the players (or of the teams, for team-based operators).
+ * @param rng Random number generator.
+ * 
+ * @return vector<int> Ids of the players to remove.
+ */
+vector<int> ruin_players(RuinOperator op, const vector<Team> &solution, const ProblemInstance &instance,
+                         double ratio, Rng &rng) {
+    int T = (int)solution.size();
+    int num_players = max(1, (int)(instance.J * ratio));
+    int num_teams = max(1, (int)(T * ratio));
+    vector<int> removed;
+
+    auto take_teams = [&](const vector<int> &teams) {
+        for (int t : teams) removed.insert(removed.end(), solution[t].players.begin(), solution[t].players.end());
+    };
+
+    switch (op) {
+    case RUIN_RANDOM: {
+        // Partial Fisher–Yates over the ids, sparse as in perturbation: O(num_players), not O(J)
+        num_players = min(num_players, instance.J);
+        unordered_map<int,int> moved_ids; // virtual array entries that differ from identity
+        moved_ids.reserve(2 * num_players);
+        auto id_at = [&](int i) {
+            auto it = moved_ids.find(i);
+            return it == moved_ids.end() ? i : it->second;
+        };
+        removed.resize(num_players);
+        for (int i = 0; i < num_players; i++) {
+            int j = i + (int)rng.below(instance.J - i);
+            int id_j = id_at(j);
+            moved_ids[j] = id_at(i);
+            removed[i] = id_j;
+        }
+        break;
+    }
+    case RUIN_LEAST_LOADED: {
+        vector<int> order(T);
+        iota(order.begin(), order.end(), 0);
+        shuffle(order.begin(), order.end(), rng);
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return solution[a].remaining_budget > solution[b].remaining_budget;
+        });
+        order.resize(min(T, num_teams));
+        take_teams(order);
+        break;
+    }
+    case RUIN_CONFLICT_NEIGHBORS: {
+        vector<int> team_of(instance.J, -1);
+        for (int t = 0; t < T; t++) {
+            for (int pid : solution[t].players) team_of[pid] = t;
+        }
+        int seed_team = (int)rng.below(T);
+        vector<int> neighbors;
+        vector<char> seen(T, 0);
+        seen[seed_team] = 1;
+        for (int pid : solution[seed_team].players) {
+            instance.adjacency->for_each_neighbor(pid, [&](int other) {
+                int t = team_of[other];
+                if (t >= 0 && !seen[t]) {
+                    seen[t] = 1;
+                    neighbors.push_back(t);
+                }
+            });
+        }
+        shuffle(neighbors.begin(), neighbors.end(), rng);
+        if ((int)neighbors.size() > max(1, num_teams - 1)) neighbors.resize(max(1, num_teams - 1));
+        neighbors.push_back(seed_team);
+        take_teams(neighbors);
+        break;
+    }
+    case RUIN_HIGHEST_SALARY: {
+        // Salary scaled by a random factor in [1, 1.5), so the choice varies between calls
+        vector<pair<double,int>> keyed(instance.J);
+        uniform_real_distribution<double> noise(1.0, 1.5);
+        for (int pid = 0; pid < instance.J; pid++) keyed[pid] = {-instance.players[pid].salary * noise(rng), pid};
+        nth_element(keyed.begin(), keyed.begin() + (num_players - 1), keyed.end());
+        for (int i = 0; i < num_players; i++) removed.push_back(keyed[i].second);
+        break;
+    }
+    default:
+        break;
+    }
+    return removed;
+}
+
+/**
+ * @brief Reinserts removed players with a recreate operator, opening new teams if needed.
+ * 
+ * @details Once the deadline is reached, the remaining players get teams of their own.
+ * 
+ * @param op The recreate operator.
+ * @param solution Solution without the removed players (modified in place).
+ * @param removed Ids of the removed players.
+ * @param instance The problem instance with players and constraints.
+ * @param rng Random number generator.
+ * @param deadline Time limit of the search.
+ * 
+ * @return void
+ */
+void recreate_players(RecreateOperator op, vector<Team> &solution, vector<int> removed,
+                      const ProblemInstance &instance, Rng &rng, Deadline &deadline) {
+    shuffle(removed.begin(), removed.end(), rng);
+    if (op == RECREATE_BEST_FIT) {
+        stable_sort(removed.begin(), removed.end(), [&](int a, int b) {
+            return instance.players[a].salary > instance.players[b].salary;
+        });
+    } else if (op == RECREATE_CONFLICT_DEGREE) {
+        stable_sort(removed.begin(), removed.end(), [&](int a, int b) {
+            return instance.adjacency->degree(a) > instance.adjacency->degree(b);
+        });
+    }
+
+    with_conflict_engine(instance, [&](const auto &engine) {
+        for (int pid : removed) {
+            const Player &p = instance.players[pid];
+            int target = -1;
+            bool out_of_time = deadline.expired();
+            for (int t = 0; t < (int)solution.size() && !out_of_time; t++) {
+                if (!can_add_to_team(solution[t], p, engine)) continue;
+                if (op != RECREATE_BEST_FIT) { target = t; break; }
+                if (target == -1 || solution[t].remaining_budget < solution[target].remaining_budget) target = t;
+            }
+            if (target != -1) {
+                solution[target].players.push_back(pid);
+                solution[target].remaining_budget -= p.salary;
+            } else {
+                Team new_team;
+                new_team.remaining_budget = instance.B - p.salary;
+                new_team.players.push_back(pid);
+                solution.push_back(move(new_team));
+            }
+        }
+    });
+}
+
+/**
+ * @brief ALNS perturbation: ruins and recreates the solution with operators chosen by
+ *        roulette wheel on their adaptive weights.
+ * 
+ * @param solution Current solution.
+ * @param rng Random number generator.
+ * @param instance The problem instance with players and constraints.
+ * @param ratio Size of the ruin (see ruin_players).
+ * @param state The ALNS state (records the chosen operators).
+ * @param deadline Time limit of the search (nothing is ruined past it).
+ * 
+ * @return vector<Team> The perturbed solution.
+ */
+vector<Team> alns_perturbation(vector<Team> solution, Rng &rng, const ProblemInstance &instance,
+                               double ratio, AlnsState &state, Deadline &deadline) {
+    if (solution.empty() || deadline.expired_now()) return solution;
+    state.last_ruin = roulette(state.ruin_weight, RUIN_COUNT, rng);
+    state.last_recreate = roulette(state.recreate_weight, RECREATE_COUNT, rng);
+
+    vector<int> removed = ruin_players((RuinOperator)state.last_ruin, solution, instance, ratio, rng);
+
+    // Remove the chosen players and drop the teams left empty
+    vector<char> is_removed(instance.J, 0);
+    for (int pid : removed) is_removed[pid] = 1;
+    for (auto &team : solution) {
+        for (int pid : team.players) {
+            if (is_removed[pid]) team.remaining_budget += instance.players[pid].salary;
+        }
+        team.players.erase(remove_if(team.players.begin(), team.players.end(), [&](int pid) { return is_removed[pid]; }),
+                           team.players.end());
+    }
+    solution.erase(remove_if(solution.begin(), solution.end(),
+                             [](const Team &team) { return team.players.empty(); }),
+                   solution.end());
+
+    recreate_players((RecreateOperator)state.last_recreate, solution, move(removed), instance, rng, deadline);
+    return solution;
+}
+
+// ================= Acceptance Criteria ================= //
+enum AcceptanceCriterion {
+    ACCEPT_ALWAYS,              // continue from every local search result
+    ACCEPT_BETTER_EQUAL,        // only if the cost does not increase
+    ACCEPT_SIMULATED_ANNEALING, // worse results with probability exp(-delta / temperature)
+    ACCEPT_LATE_ACCEPTANCE      // if not worse than the accepted cost L iterations ago
+};
+
+/**
+ * @brief Fine-grained cost of a solution: the number of teams minus the mean squared load
+ *        (load = salary used / B).
+ * 
+ * @details The mean squared load lies in (0, 1], so the cost orders solutions by number of
+ *          teams first; between solutions with as many teams it prefers the one whose slack
+ *          is concentrated in few teams, which is the one closest to losing a team.
+ * 
+ * @param solution The solution.
+ * @param instance The problem instance with players and constraints.
+ * 
+ * @return double The cost (lower is better).
+ */
+double solution_cost(const vector<Team> &solution, const ProblemInstance &instance) {
+    if (solution.empty()) return 0;
+    double B = instance.B;
+    return solution.size() - squared_loads(solution, instance) / (B * B * solution.size());
+}
+
+struct Acceptance {
+    AcceptanceCriterion criterion = ACCEPT_ALWAYS;
+    double temperature = 0.5; // simulated annealing: current temperature
+    double cooling = 0.999; // simulated annealing: temperature factor per iteration
+    vector<double> history; // late acceptance: accepted costs of the last L iterations
+    size_t position = 0;
+
+    /**
+     * @brief Decides whether the search continues from a candidate solution.
+     * 
+     * @param candidate_cost Cost of the new local search result.
+     * @param accepted_cost Cost of the solution the search continues from now.
+     * @param rng Random number generator.
+     * 
+     * @return true If the candidate becomes the accepted solution.
+     */
+    bool accept(double candidate_cost, double accepted_cost, Rng &rng) {
+        switch (criterion) {
+        case ACCEPT_ALWAYS:
+            return true;
+        case ACCEPT_BETTER_EQUAL:
+            return candidate_cost <= accepted_cost;
+        case ACCEPT_SIMULATED_ANNEALING: {
+            bool ok = candidate_cost <= accepted_cost ||
+                      uniform_real_distribution<double>(0, 1)(rng) < exp((accepted_cost - candidate_cost) / temperature);
+            temperature = max(temperature * cooling, 1e-9);
+            return ok;
+        }
+        case ACCEPT_LATE_ACCEPTANCE: {
+            if (history.empty()) history.assign(1, accepted_cost);
+            double &late = history[position];
+            bool ok = candidate_cost <= late || candidate_cost <= accepted_cost;
+            late = ok ? candidate_cost : accepted_cost;
+            position = (position + 1) % history.size();
+            return ok;
+        }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Parses the name of an acceptance criterion.
+ * 
+ * @param name "always", "better_equal", "sa" or "lahc".
+ * 
+ * @return AcceptanceCriterion The criterion.
+ * @throws runtime_error If the name is unknown.
+ */
+AcceptanceCriterion parse_acceptance(const string &name) {
+    if (name == "always") return ACCEPT_ALWAYS;
+    if (name == "better_equal") return ACCEPT_BETTER_EQUAL;
+    if (name == "sa") return ACCEPT_SIMULATED_ANNEALING;
+    if (name == "lahc") return ACCEPT_LATE_ACCEPTANCE;
+    throw runtime_error("Unknown acceptance criterion: " + name);
+}
+
+const char *acceptance_name(AcceptanceCriterion criterion) {
+    static const char *names[] = {"always", "better_equal", "sa", "lahc"};
+    return names[criterion];
+}
+
+// ================= Iterated Local Search ================= //
+struct IlsParams {
+    double perturbation_ratio = 0.15; // percentage of players moved by each perturbation
+    int pool_interval = 0; // iterations between pool recombinations (0 = disabled)
+    bool alns = false; // perturb with adaptive ruin & recreate operators instead of perturbation
+    AcceptanceCriterion acceptance = ACCEPT_ALWAYS; // which local search results the search continues from
+    double sa_temperature = 0.5; // initial temperature (in teams) of the simulated annealing acceptance
+    double sa_cooling = 0.999; // temperature factor per iteration
+    int lahc_length = 50; // history length of the late acceptance criterion
+    int stagnation_limit = DEFAULT_STAGNATION_LIMIT; // local search iterations without improvement
+    int exact_interval = 0; // iterations without a new best between exact repacking rounds (0 = disabled)
+    long long exact_nodes = 100000; // node limit of each exact repacking
+    bool matching = false; // local search matches the players First Fit leaves out once it stagnates (see match_left_out)
+};
+
+/**
+ * @brief Iterated Local Search: alternates local_search and perturbation until the deadline
+ *        is reached or should_stop() is true.
+ * 
+ * @details When params.pool_interval > 0 the teams of every local search result are
+ *          harvested into a TeamPool, and every pool_interval iterations the pool is
+ *          recombined; the recombined solution replaces the current one if it is not worse.
+ *          When params.alns is set, alns_perturbation replaces perturbation, and its operators
+ *          are credited with the result of the following local search.
+ *          When params.exact_interval > 0 and that many iterations passed without a new best,
+ *          a round of EXACT_ATTEMPTS exact_repack moves is applied to the local search result.
+ *          When params.matching is set, the local search, once stagnated, retries completing
+ *          its redistributions by a matching (see match_left_out).
+ *          After each local search, params.acceptance decides whether the search continues
+ *          from the new result or goes back to the last accepted solution (solution_cost).
+ *          Between solutions with as many teams, the best one is the one with the highest
+ *          squared_loads; such updates are not reported to on_new_best.
+ * 
+ * @param instance The problem instance with players and constraints.
+ * @param current_solution Solution the search starts from.
+ * @param best_solution Best solution known so far.
+ * @param rng Random number generator.
+ * @param params Search parameters.
+ * @param iterations_done Input/output: number of iterations done.
+ * @param deadline Time limit, also polled inside local_search and the perturbations (the
+ *                 caller can check deadline.reached afterwards).
+ * @param should_stop Checked before every iteration.
+ * @param on_new_best Called with every new best solution.
+ * @param after_iteration Called after every iteration with the best and the current solutions.
+ * 
+ * @return vector<Team> The best solution found.
+ */
+vector<Team> ils_search(const ProblemInstance &instance, vector<Team> current_solution, vector<Team> best_solution,
+                        Rng &rng, const IlsParams &params, int &iterations_done, Deadline &deadline,
+                        const function<bool()> &should_stop,
+                        const function<void(const vector<Team> &)> &on_new_best,
+                        const function<void(const vector<Team> &, const vector<Team> &)> &after_iteration) {
+    TeamPool pool;
+    AlnsState alns;
+    size_t teams_before_perturbation = current_solution.size();
+
+    Acceptance acceptance;
+    acceptance.criterion = params.acceptance;
+    acceptance.temperature = params.sa_temperature;
+    acceptance.cooling = params.sa_cooling;
+    vector<Team> accepted_solution;
+    double accepted_cost = 0;
+    bool has_accepted = false;
+    long long best_squared = squared_loads(best_solution, instance);
+    int last_improvement = iterations_done; // iteration of the last new best (or exact repacking round)
+
+    // Compute local search with perturbation many times
+    while (!deadline.expired_now() && !should_stop()) {
+        current_solution = local_search(current_solution, instance, deadline, params.stagnation_limit, params.matching);
+
+        // Keep the good teams built by the local search and periodically recombine them
+        if (params.pool_interval > 0) {
+            harvest_teams(pool, current_solution, instance);
+            if ((iterations_done + 1) % params.pool_interval == 0) {
+                auto recombined = local_search(recombine_pool(pool, instance, rng), instance, deadline, params.stagnation_limit,
+                                               params.matching);
+                if (recombined.size() <= current_solution.size()) {
+                    current_solution = recombined;
+                }
+            }
+        }
+
+        // On a plateau, try to remove teams by repacking a few of them exactly
+        if (params.exact_interval > 0 && iterations_done - last_improvement >= params.exact_interval) {
+            last_improvement = iterations_done;
+            for (int attempt = 0; attempt < EXACT_ATTEMPTS && !deadline.expired_now(); attempt++) {
+                exact_repack(current_solution, instance, rng, params.exact_nodes, deadline);
+            }
+        }
+
+        if (params.alns) {
+            double score = current_solution.size() < best_solution.size() ? AlnsState::SCORE_BEST
+                         : current_solution.size() < teams_before_perturbation ? AlnsState::SCORE_BETTER
+                         : current_solution.size() == teams_before_perturbation ? AlnsState::SCORE_EQUAL : 0;
+            alns_update(alns, score);
+        }
+
+        long long current_squared = squared_loads(current_solution, instance);
+        if (current_solution.size() < best_solution.size()) {
+            best_solution = current_solution;
+            best_squared = current_squared;
+            last_improvement = iterations_done;
+            on_new_best(best_solution);
+        } else if (current_solution.size() == best_solution.size() && current_squared > best_squared) {
+            // Same number of teams, but closer to losing one: keep it without reporting
+            best_solution = current_solution;
+            best_squared = current_squared;
+        }
+
+        // Continue from the new result or from the last accepted solution
+        double current_cost = solution_cost(current_solution, instance);
+        if (!has_accepted) {
+            acceptance.history.assign(max(1, params.lahc_length), current_cost);
+        }
+        if (!has_accepted || acceptance.accept(current_cost, accepted_cost, rng)) {
+            // ACCEPT_ALWAYS never goes back, so it needs no copy
+            if (params.acceptance != ACCEPT_ALWAYS) accepted_solution = current_solution;
+            accepted_cost = current_cost;
+            has_accepted = true;
+        } else {
+            current_solution = accepted_solution;
+        }
+
+        teams_before_perturbation = current_solution.size();
+        if (params.alns) {
+            current_solution = alns_perturbation(move(current_solution), rng, instance, params.perturbation_ratio, alns, deadline);
+        } else {
+            current_solution = perturbation(move(current_solution), rng, instance, params.perturbation_ratio, deadline);
+        }
+
+        iterations_done++;
+        LOG(LOG_TRACE, "ILS iteration " << iterations_done << ": " << current_solution.size() << " teams after perturbation.\n");
+        after_iteration(best_solution, current_solution);
+    }
+
+    return best_solution;
+}
+
+// ================= Memetic Search ================= //
+struct Individual {
+    vector<Team> teams;
+    vector<uint64_t> signature; // sorted membership hashes of the teams
+};
+
+/**
+ * @brief Builds an individual, computing the membership signature of its teams.
+ * 
+ * @param teams The solution of the individual.
+ * 
+ * @return Individual The individual with its signature.
+ */
+Individual make_individual(vector<Team> teams) {
+    Individual ind;
+    ind.signature.reserve(teams.size());
+    for (const auto &team : teams) {
+        vector<int> members = team.players;
+        sort(members.begin(), members.end());
+        ind.signature.push_back(hash_membership(members));
+    }
+    sort(ind.signature.begin(), ind.signature.end());
+    ind.teams = move(teams);
+    return ind;
+}
+
+/**
+ * @brief Counts the teams of one individual that do not exist in the other.
+ * 
+ * @param a First individual.
+ * @param b Second individual.
+ * 
+ * @return int Number of teams of a missing in b (0 means same solution).
+ */
+int individual_distance(const Individual &a, const Individual &b) {
+    int common = 0;
+    size_t i = 0, j = 0;
+    while (i < a.signature.size() && j < b.signature.size()) {
+        if (a.signature[i] == b.signature[j]) { common++; i++; j++; }
+        else if (a.signature[i] < b.signature[j]) i++;
+        else j++;
+    }
+    return (int)a.signature.size() - common;
+}
+
+/**
+ * @brief Runs local_search on every solution, spreading them over all available cores.
+ * 
+ * @param solutions Solutions to improve (replaced in place).
+ * @param instance The problem instance with players and constraints.
+ * @param deadline Time limit (each thread polls its own copy).
+ * @param params Search parameters (stagnation_limit and matching are used).
+ * 
+ * @return void
+ */
+void parallel_local_search(vector<vector<Team>> &solutions, const ProblemInstance &instance, const Deadline &deadline,
+                           const IlsParams &params) {
+    size_t workers = max(1u, thread::hardware_concurrency());
+    workers = min(workers, solutions.size());
+
+    atomic<size_t> next{0};
+    auto work = [&]() {
+        Deadline local_deadline = deadline;
+        for (size_t i; (i = next++) < solutions.size();) {
+            solutions[i] = local_search(solutions[i], instance, local_deadline, params.stagnation_limit, params.matching);
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t w = 1; w < workers; w++) threads.emplace_back(work);
+    work();
+    for (auto &t : threads) t.join();
+}
+
+/**
+ * @brief Grouping crossover: the child inherits whole teams from both parents.
+ * 
+ * @details The child takes a random number (between 1/4 and 3/4) of the fullest teams of
+ *          the first parent, then every team of the second parent (fullest first) that is
+ *          disjoint from the inherited ones. The missing players are reinserted by First Fit,
+ *          highest salary first.
+ * 
+ * @param a First parent.
+ * @param b Second parent.
+ * @param instance The problem instance with players and constraints.
+ * @param rng Random number generator for the crossing point and reinsertion order.
+ * 
+ * @return vector<Team> The child solution.
+ */
+vector<Team> grouping_crossover(const vector<Team> &a, const vector<Team> &b,
+                                const ProblemInstance &instance, Rng &rng) {
+    auto fullest_first = [](const vector<Team> &teams) {
+        vector<int> order(teams.size());
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](int x, int y) {
+            return teams[x].remaining_budget < teams[y].remaining_budget;
+        });
+        return order;
+    };
+
+    vector<char> taken(instance.J, 0);
+    vector<Team> child;
+
+    // Fullest teams of the first parent
+    vector<int> order_a = fullest_first(a);
+    int lo = max(1, (int)a.size() / 4);
+    int hi = max(lo, 3 * (int)a.size() / 4);
+    int cut = uniform_int_distribution<int>(lo, hi)(rng);
+    for (int k = 0; k < cut && k < (int)order_a.size(); k++) {
+        const Team &team = a[order_a[k]];
+        for (int pid : team.players) taken[pid] = 1;
+        child.push_back(team);
+    }
+
+    // Disjoint teams of the second parent
+    for (int t : fullest_first(b)) {
+        const Team &team = b[t];
+        bool disjoint = true;
+        for (int pid : team.players) {
+            if (taken[pid]) { disjoint = false; break; }
+        }
+        if (!disjoint) continue;
+        for (int pid : team.players) taken[pid] = 1;
+        child.push_back(team);
+    }
+
+    // Reinsert missing players (First Fit)
+    vector<int> missing;
+    for (int pid = 0; pid < instance.J; pid++) {
+        if (!taken[pid]) missing.push_back(pid);
+    }
+    shuffle(missing.begin(), missing.end(), rng);
+    stable_sort(missing.begin(), missing.end(), [&](int x, int y) {
+        return instance.players[x].salary > instance.players[y].salary;
+    });
+    for (int pid : missing) {
+        const Player &p = instance.players[pid];
+        bool placed = false;
+        for (auto &team : child) {
+            if (can_add_to_team(team, p, instance)) {
+                team.players.push_back(pid);
+                team.remaining_budget -= p.salary;
+                placed = true;
+                break;
+            }
+        }
+        if (!placed) {
+            Team new_team;
+            new_team.remaining_budget = instance.B - p.salary;
+            new_team.players.push_back(pid);
+            child.push_back(move(new_team));
+        }
+    }
+
+    return child;
+}
+
+/**
+ * @brief Population-based search (memetic algorithm) using local_search as improvement operator.
+ * 
+ * @details 1. The population is built with construct_initial_solution (one seed per individual,
+ *             with the given constructor) followed by local_search.
+ *             The given initial solution is the first individual. If the deadline is
+ *             reached while building it, the population stays smaller.
+ *          2. Each generation creates one child per core: two parents are chosen by binary
+ *             tournament, recombined with grouping_crossover and improved by local_search
+ *             (children are evaluated in parallel).
+ *          3. Diversity-aware replacement: a child identical to an individual is dropped;
+ *             otherwise it replaces, among the individuals with at least as many teams,
+ *             the one most similar to it.
+ * 
+ * @param instance The problem instance with players and constraints.
+ * @param initial Solution used as the first individual.
+ * @param rng Random number generator.
+ * @param population_size Number of individuals.
+ * @param params Search parameters of the local searches (see parallel_local_search).
+ * @param constructor Construction of the other individuals of the initial population.
+ * @param start Start time of the run.
+ * @param time_limit Time limit in seconds.
+ * @param children_done Output: number of children evaluated.
+ * @param on_new_best Called with every new best solution.
+ * 
+ * @return vector<Team> The best solution found.
+ */
+vector<Team> memetic_search(const ProblemInstance &instance, const vector<Team> &initial, Rng &rng, int population_size,
+                            const IlsParams &params, Constructor constructor,
+                            chrono::high_resolution_clock::time_point start, double time_limit,
+                            int &children_done, const function<void(const vector<Team> &)> &on_new_best) {
+    Deadline deadline(start, time_limit);
+
+    // Initial population
+    vector<vector<Team>> seeds = {initial};
+    for (int i = 1; i < population_size && !deadline.expired_now(); i++) {
+        Rng stream = rng.split();
+        seeds.push_back(construct_initial_solution(instance, stream, constructor));
+    }
+    parallel_local_search(seeds, instance, deadline, params);
+
+    vector<Individual> population;
+    for (auto &sol : seeds) population.push_back(make_individual(move(sol)));
+
+    int best_idx = 0;
+    for (int i = 1; i < (int)population.size(); i++) {
+        if (population[i].teams.size() < population[best_idx].teams.size()) best_idx = i;
+    }
+    vector<Team> best_solution = population[best_idx].teams;
+    on_new_best(best_solution); // main keeps it only if it beats its own incumbent
+
+    auto tournament = [&]() {
+        uniform_int_distribution<int> pick(0, (int)population.size() - 1);
+        int x = pick(rng), y = pick(rng);
+        return population[x].teams.size() <= population[y].teams.size() ? x : y;
+    };
+
+    size_t batch = max(1u, thread::hardware_concurrency());
+    while (!deadline.expired_now()) {
+        // Crossover
+        vector<vector<Team>> children;
+        for (size_t c = 0; c < batch; c++) {
+            int pa = tournament(), pb = tournament();
+            children.push_back(grouping_crossover(population[pa].teams, population[pb].teams, instance, rng));
+        }
+
+        // Improvement
+        parallel_local_search(children, instance, deadline, params);
+        children_done += (int)children.size();
+
+        // Replacement
+        for (auto &sol : children) {
+            Individual child = make_individual(move(sol));
+
+            if (child.teams.size() < best_solution.size()) {
+                best_solution = child.teams;
+                on_new_best(best_solution); // main keeps it only if it beats its own incumbent
+            }
+
+            int target = -1, target_distance = 0;
+            bool duplicate = false;
+            for (int i = 0; i < (int)population.size(); i++) {
+                int d = individual_distance(child, population[i]);
+                if (d == 0) { duplicate = true; break; }
+                if (population[i].teams.size() < child.teams.size()) continue;
+                if (target == -1 || d < target_distance ||
+                    (d == target_distance && population[i].teams.size() > population[target].teams.size())) {
+                    target = i;
+                    target_distance = d;
+                }
+            }
+            if (!duplicate && target != -1) population[target] = move(child);
+        }
+    }
+
+    return best_solution;
+}
+
+
+// ================= Benchmark ================= //
+/**
+ * @brief Returns the peak resident memory of the process.
+ * 
+ * @return long Peak resident set size in kilobytes.
+ */
+long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief Times one construction, one local_search and one perturbation and appends the
+ *        timings, team counts and peak resident memory to scaling_results.csv.
+ * 
+ * @param instance_file Name of the instance file (first column of the csv).
+ * @param instance The problem instance with players and constraints.
+ * @param read_seconds Time spent reading the instance.
+ * @param rng Random number generator.
+ * @param perturbation_ratio The percentage of players to perturb.
+ * 
+ * @return void
+ * @throws runtime_error If the csv file cannot be opened.
+ */
+void run_benchmark(const string &instance_file, const ProblemInstance &instance, double read_seconds,
+                   Rng &rng, double perturbation_ratio) {
+    auto seconds_since = [](chrono::high_resolution_clock::time_point t0) {
+        return chrono::duration_cast<chrono::duration<double>>(chrono::high_resolution_clock::now() - t0).count();
+    };
+    long rss_read = peak_rss_kb();
+
+    auto t0 = chrono::high_resolution_clock::now();
+    auto constructed = construct_initial_solution(instance, rng);
+    double construction_seconds = seconds_since(t0);
+    long rss_construction = peak_rss_kb();
+    LOG(LOG_INFO, "Construction: " << construction_seconds << "s, " << constructed.size() << " teams.\n");
+
+    Deadline unlimited;
+    t0 = chrono::high_resolution_clock::now();
+    auto improved = local_search(constructed, instance, unlimited);
+    double local_search_seconds = seconds_since(t0);
+    long rss_local_search = peak_rss_kb();
+    LOG(LOG_INFO, "Local search: " << local_search_seconds << "s, " << improved.size() << " teams.\n");
+
+    t0 = chrono::high_resolution_clock::now();
+    auto perturbed = perturbation(improved, rng, instance, perturbation_ratio, unlimited);
+    double perturbation_seconds = seconds_since(t0);
+    long rss_perturbation = peak_rss_kb();
+    LOG(LOG_INFO, "Perturbation: " << perturbation_seconds << "s, " << perturbed.size() << " teams.\n"
+               << "Peak RSS: " << rss_perturbation << " KB\n");
+
+    const string csv_filename = "scaling_results.csv";
+    bool new_file = !ifstream(csv_filename).good();
+    ofstream outfile(csv_filename, ios_base::app);
+    if (!outfile.is_open()) {
+        throw runtime_error("Can not open CSV file for writing named " + csv_filename);
+    }
+    if (new_file) {
+        outfile << "instance,players,conflicts,read_s,rss_read_kb,construction_s,construction_teams,rss_construction_kb,"
+                << "local_search_s,local_search_teams,rss_local_search_kb,perturbation_s,perturbation_teams,rss_perturbation_kb\n";
+    }
+    outfile << instance_file << "," << instance.J << "," << instance.I << ","
+            << read_seconds << "," << rss_read << ","
+            << construction_seconds << "," << constructed.size() << "," << rss_construction << ","
+            << local_search_seconds << "," << improved.size() << "," << rss_local_search << ","
+            << perturbation_seconds << "," << perturbed.size() << "," << rss_perturbation << "\n";
+}
+
+
+// ================= Parameter Tuning ================= //
+constexpr int TUNE_ITERATIONS = 3; // races per instance
+constexpr int TUNE_FIRST_TEST = 4; // blocks (seeds) before the first elimination test
+constexpr int TUNE_ELITES = 2; // configurations carried over to the next race
+constexpr double TUNE_ALPHA = 0.05; // significance level of the tests
+
+// Cheap features of an instance, used to pick a tuned configuration (see load_config_model)
+struct InstanceFeatures {
+    int players = 0;
+    double density = 0; // conflicts / (J (J - 1) / 2)
+    double salary_ratio = 0; // mean salary / B
+};
+
+// Parameters chosen by the tuner
+struct TunedConfig {
+    double perturbation_ratio = 0.15;
+    int stagnation_limit = DEFAULT_STAGNATION_LIMIT;
+    Constructor constructor = CONSTRUCT_FIRST_FIT;
+    AcceptanceCriterion acceptance = ACCEPT_ALWAYS;
+};
+
+InstanceFeatures instance_features(const ProblemInstance &instance) {
+    InstanceFeatures f;
+    f.players = instance.J;
+    double pairs = instance.J * (instance.J - 1.0) / 2;
+    f.density = pairs > 0 ? instance.I / pairs : 0;
+    long long salaries = 0;
+    for (const auto &p : instance.players) salaries += p.salary;
+    f.salary_ratio = instance.J ? (double)salaries / instance.J / instance.B : 0;
+    return f;
+}
+
+/**
+ * @brief Distance between two instances in feature space: log10 of the number of players,
+ *        log10 of the density and 10 × the salary ratio, so that each is roughly unit scale.
+ */
+double feature_distance(const InstanceFeatures &a, const InstanceFeatures &b) {
+    double dj = log10(max(1, a.players)) - log10(max(1, b.players));
+    double dd = log10(max(a.density, 1e-9)) - log10(max(b.density, 1e-9));
+    double ds = 10 * (a.salary_ratio - b.salary_ratio);
+    return sqrt(dj * dj + dd * dd + ds * ds);
+}
+
+string format_config(const TunedConfig &c) {
+    ostringstream out;
+    out << "perturbation_ratio " << c.perturbation_ratio << ", stagnation " << c.stagnation_limit
+        << ", constructor " << constructor_name(c.constructor) << ", acceptance " << acceptance_name(c.acceptance);
+    return out.str();
+}
+
+// Tuned configurations with the features of the instances they were tuned on
+struct ConfigModel {
+    vector<string> instances;
+    vector<InstanceFeatures> features;
+    vector<TunedConfig> configs;
+};
+
+/**
+ * @brief Reads a model written by run_tuner.
+ * 
+ * @param filename The CSV file (instance,players,density,salary_ratio,perturbation_ratio,
+ *                 stagnation,constructor,acceptance,...).
+ * 
+ * @return ConfigModel The model.
+ * @throws runtime_error If the file cannot be read or a row is malformed.
+ */
+ConfigModel load_config_model(const string &filename) {
+    ifstream in(filename);
+    if (!in.is_open()) throw runtime_error("Could not open config file " + filename);
+    ConfigModel model;
+    string line;
+    getline(in, line); // header
+    while (getline(in, line)) {
+        if (line.empty()) continue;
+        vector<string> fields;
+        istringstream ls(line);
+        for (string field; getline(ls, field, ',');) fields.push_back(field);
+        if (fields.size() < 8) throw runtime_error("Malformed config row: " + line);
+        InstanceFeatures f;
+        TunedConfig c;
+        f.players = stoi(fields[1]);
+        f.density = stod(fields[2]);
+        f.salary_ratio = stod(fields[3]);
+        c.perturbation_ratio = stod(fields[4]);
+        c.stagnation_limit = stoi(fields[5]);
+        c.constructor = parse_constructor(fields[6]);
+        c.acceptance = parse_acceptance(fields[7]);
+        model.instances.push_back(fields[0]);
+        model.features.push_back(f);
+        model.configs.push_back(c);
+    }
+    if (model.configs.empty()) throw runtime_error("Config file " + filename + " has no rows");
+    return model;
+}
+
+/**
+ * @brief Index of the row of the model whose instance is nearest (feature_distance).
+ */
+size_t nearest_config(const ConfigModel &model, const InstanceFeatures &features) {
+    size_t best = 0;
+    for (size_t r = 1; r < model.configs.size(); r++) {
+        if (feature_distance(model.features[r], features) < feature_distance(model.features[best], features)) best = r;
+    }
+    return best;
+}
+
+/**
+ * @brief Upper tail of the chi-square distribution (Wilson–Hilferty approximation).
+ */
+double chi_square_survival(double x, double df) {
+    if (x <= 0) return 1;
+    double z = (cbrt(x / df) - (1 - 2 / (9 * df))) / sqrt(2 / (9 * df));
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+/**
+ * @brief Quantile of Student's t distribution from the normal quantile z
+ *        (Cornish–Fisher expansion, accurate for df >= 3).
+ */
+double student_t_quantile(double z, double df) {
+    double z3 = z * z * z, z5 = z3 * z * z, z7 = z5 * z * z;
+    return z + (z3 + z) / (4 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96 * df * df)
+             + (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * df * df * df);
+}
+
+/**
+ * @brief Friedman test over the results of the candidates still racing, with Conover's
+ *        post-hoc comparison against the best one (as in F-Race / irace).
+ * 
+ * @param costs costs[c][b]: cost of candidate c on block (seed) b; all rows have b blocks.
+ * 
+ * @return vector<bool> For each candidate, whether it is significantly worse than the best.
+ */
+vector<bool> friedman_eliminate(const vector<vector<double>> &costs) {
+    size_t k = costs.size(), b = costs.empty() ? 0 : costs[0].size();
+    vector<bool> worse(k, false);
+    if (k < 2 || b < 2) return worse;
+
+    // Ranks within each block (ties get the mean rank)
+    vector<double> rank_sum(k, 0);
+    double a1 = 0;
+    vector<int> order(k);
+    for (size_t blk = 0; blk < b; blk++) {
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](int x, int y) { return costs[x][blk] < costs[y][blk]; });
+        for (size_t i = 0; i < k;) {
+            size_t j = i;
+            while (j + 1 < k && costs[order[j + 1]][blk] == costs[order[i]][blk]) j++;
+            double rank = (i + j) / 2.0 + 1;
+            for (size_t t = i; t <= j; t++) {
+                rank_sum[order[t]] += rank;
+                a1 += rank * rank;
+            }
+            i = j + 1;
+        }
+    }
+
+    double c1 = b * k * (k + 1.0) * (k + 1.0) / 4;
+    double sum_r2 = 0;
+    for (double r : rank_sum) sum_r2 += r * r;
+    if (a1 - c1 <= 1e-12) return worse; // every block tied
+    double statistic = (k - 1.0) * (sum_r2 - b * c1) / (a1 - c1);
+    if (chi_square_survival(statistic, k - 1.0) >= TUNE_ALPHA) return worse;
+
+    double df = (b - 1.0) * (k - 1.0);
+    double critical = student_t_quantile(1.959964, df) * sqrt(max(0.0, 2 * (b * a1 - sum_r2) / df));
+    double best = *min_element(rank_sum.begin(), rank_sum.end());
+    for (size_t c = 0; c < k; c++) worse[c] = rank_sum[c] - best > critical;
+    return worse;
+}
+
+/**
+ * @brief Draws a configuration: uniformly, or around a parent with a spread that shrinks
+ *        with the race number.
+ * 
+ * @param parent Configuration to sample around (nullptr: uniform).
+ * @param race Number of the race (0-based).
+ * @param rng Random number generator.
+ * 
+ * @return TunedConfig The configuration.
+ */
+TunedConfig sample_config(const TunedConfig *parent, int race, Rng &rng) {
+    uniform_real_distribution<double> unit(0, 1);
+    TunedConfig c;
+    if (!parent) {
+        c.perturbation_ratio = 0.02 + 0.58 * unit(rng);
+        c.stagnation_limit = 5 + (int)rng.below(96);
+        c.constructor = (Constructor)rng.below(CONSTRUCTOR_COUNT);
+        c.acceptance = (AcceptanceCriterion)rng.below(ACCEPT_LATE_ACCEPTANCE + 1);
+        return c;
+    }
+    double spread = 1.0 / (race + 1);
+    normal_distribution<double> noise(0, 1);
+    c.perturbation_ratio = min(0.6, max(0.02, parent->perturbation_ratio + 0.1 * spread * noise(rng)));
+    c.stagnation_limit = min(100, max(5, (int)lround(parent->stagnation_limit + 15 * spread * noise(rng))));
+    c.constructor = unit(rng) < 0.2 * spread ? (Constructor)rng.below(CONSTRUCTOR_COUNT) : parent->constructor;
+    c.acceptance = unit(rng) < 0.2 * spread ? (AcceptanceCriterion)rng.below(ACCEPT_LATE_ACCEPTANCE + 1) : parent->acceptance;
+    return c;
+}
+
+/**
+ * @brief Runs the ILS once with a configuration and returns the solution_cost of the result.
+ */
+double evaluate_config(const ProblemInstance &instance, const TunedConfig &config, uint64_t seed, double time) {
+    auto start = chrono::high_resolution_clock::now();
+    Rng rng(seed);
+    vector<Team> initial = construct_initial_solution(instance, rng, config.constructor);
+    IlsParams params;
+    params.perturbation_ratio = config.perturbation_ratio;
+    params.stagnation_limit = config.stagnation_limit;
+    params.acceptance = config.acceptance;
+    Deadline deadline(start, time);
+    int iterations = 0;
+    vector<Team> best = ils_search(instance, initial, initial, rng, params, iterations, deadline,
+        []() { return false; }, [](const vector<Team> &) {}, [](const vector<Team> &, const vector<Team> &) {});
+    return solution_cost(best, instance);
+}
+
+/**
+ * @brief Iterated racing on one instance (irace-style).
+ * 
+ * @details Each of the TUNE_ITERATIONS races gets an equal share of the remaining budget
+ *          and budget / (TUNE_FIRST_TEST + race) candidates: the elites of the previous race
+ *          plus new configurations sampled around them (the first race samples uniformly and
+ *          includes the default configuration). Every block runs all surviving candidates on
+ *          a new seed, in parallel; from the TUNE_FIRST_TEST-th block on, candidates that the
+ *          Friedman test finds worse than the best are dropped. A race ends when at most
+ *          TUNE_ELITES candidates survive or its budget runs out.
+ * 
+ * @param instance The problem instance.
+ * @param time Time limit of each run in seconds.
+ * @param budget Number of runs.
+ * @param workers Runs executed at once.
+ * @param rng Random number generator for sampling and seeds.
+ * @param mean_cost Output: mean cost of the chosen configuration in the last race.
+ * 
+ * @return TunedConfig The best configuration found.
+ */
+TunedConfig race_instance(const ProblemInstance &instance, double time, int budget, size_t workers, Rng &rng,
+                          double &mean_cost) {
+    vector<TunedConfig> elites;
+    int used = 0;
+    uint64_t next_seed = rng();
+    TunedConfig best_config;
+    mean_cost = numeric_limits<double>::infinity();
+
+    for (int race = 0; race < TUNE_ITERATIONS && used < budget; race++) {
+        int race_budget = (budget - used) / (TUNE_ITERATIONS - race);
+        int count = max((int)elites.size() + 1, race_budget / (TUNE_FIRST_TEST + race));
+        vector<TunedConfig> candidates = elites;
+        if (race == 0) candidates.push_back(TunedConfig());
+        while ((int)candidates.size() < count) {
+            const TunedConfig *parent = elites.empty() ? nullptr : &elites[rng.below(elites.size())];
+            candidates.push_back(sample_config(parent, race, rng));
+        }
+
+        vector<vector<double>> costs(candidates.size());
+        vector<int> alive(candidates.size());
+        iota(alive.begin(), alive.end(), 0);
+        int race_used = 0, blocks = 0;
+        while (race_used + (int)alive.size() <= race_budget && (blocks < TUNE_FIRST_TEST || (int)alive.size() > TUNE_ELITES)) {
+            uint64_t seed = next_seed++;
+            vector<double> block(alive.size());
+            atomic<size_t> next{0};
+            auto work = [&]() {
+                for (size_t i; (i = next++) < alive.size();) {
+                    block[i] = evaluate_config(instance, candidates[alive[i]], seed, time);
+                }
+            };
+            vector<thread> threads;
+            for (size_t w = 1; w < min(workers, alive.size()); w++) threads.emplace_back(work);
+            work();
+            for (auto &t : threads) t.join();
+            for (size_t i = 0; i < alive.size(); i++) costs[alive[i]].push_back(block[i]);
+            race_used += (int)alive.size();
+            blocks++;
+
+            if (blocks >= TUNE_FIRST_TEST) {
+                vector<vector<double>> racing;
+                for (int c : alive) racing.push_back(costs[c]);
+                vector<bool> worse = friedman_eliminate(racing);
+                vector<int> survivors;
+                for (size_t i = 0; i < alive.size(); i++) {
+                    if (!worse[i]) survivors.push_back(alive[i]);
+                }
+                alive = survivors;
+            }
+        }
+        used += race_used;
+        if (blocks == 0) break;
+
+        // Elites: survivors with the lowest mean cost
+        auto mean = [&](int c) { return accumulate(costs[c].begin(), costs[c].end(), 0.0) / costs[c].size(); };
+        sort(alive.begin(), alive.end(), [&](int x, int y) { return mean(x) < mean(y); });
+        elites.clear();
+        for (size_t i = 0; i < alive.size() && (int)i < TUNE_ELITES; i++) elites.push_back(candidates[alive[i]]);
+        best_config = candidates[alive[0]];
+        mean_cost = mean(alive[0]);
+        LOG(LOG_INFO, "  race " << race + 1 << ": " << candidates.size() << " candidates, " << blocks << " seeds, "
+             << alive.size() << " left; best mean cost " << mean_cost << " (" << format_config(best_config) << ")\n");
+    }
+    return best_config;
+}
+
+/**
+ * @brief Tuning mode: races the parameters on every instance and writes the model read by
+ *        --config (one row per instance with its features and its best configuration).
+ * 
+ * @param instance_files Training instances.
+ * @param time Time limit of each run in seconds.
+ * @param budget Runs per instance.
+ * @param workers Runs executed at once.
+ * @param seed Seed of the sampling.
+ * @param output_file The model (CSV).
+ * 
+ * @return int Exit code.
+ */
+int run_tuner(const vector<string> &instance_files, double time, int budget, size_t workers, uint64_t seed,
+              const string &output_file) {
+    Rng rng(seed);
+    ostringstream rows;
+    rows << "instance,players,density,salary_ratio,perturbation_ratio,stagnation,constructor,acceptance,mean_cost,runs\n";
+    for (const auto &file : instance_files) {
+        ProblemInstance instance = read_instance(file);
+        InstanceFeatures f = instance_features(instance);
+        LOG(LOG_INFO, file << ": " << f.players << " players, density " << f.density
+             << ", salary ratio " << f.salary_ratio << "\n");
+        double mean_cost;
+        TunedConfig c = race_instance(instance, time, budget, workers, rng, mean_cost);
+        rows << file << "," << f.players << "," << f.density << "," << f.salary_ratio << ","
+             << c.perturbation_ratio << "," << c.stagnation_limit << "," << constructor_name(c.constructor) << ","
+             << acceptance_name(c.acceptance) << "," << mean_cost << "," << budget << "\n";
+    }
+    write_file_atomically(output_file, [&](ostream &out) { out << rows.str(); });
+    LOG(LOG_INFO, "Model saved to " << output_file << "\n");
+    return 0;
+}
+
+
+// ================= Instance Deltas ================= //
+/*
+ * A delta file changes a loaded instance, one change per line ('#' starts a comment):
+ *   budget <B>               new budget of every team
+ *   add <salary>             new player, numbered after the existing ones (J + 1, J + 2, ...)
+ *   salary <player> <salary> new salary
+ *   remove <player>          the player leaves; the ones after it are renumbered down
+ *   conflict <a> <b>         new conflict
+ *   unconflict <a> <b>       the conflict is dropped
+ * Player ids are 1-based and refer to the instance before the delta (added players included);
+ * removals are applied last. When a line repeats a salary or a conflict, the last one wins.
+ */
+struct InstanceDelta {
+    int budget = -1; // new B (-1 = unchanged)
+    vector<int> added_salaries; // salaries of the new players
+    map<int, int> salaries; // player -> new salary
+    set<int> removed; // players that leave
+    map<pair<int,int>, bool> conflicts; // (a, b) with a < b -> true if added, false if dropped
+};
+
+/**
+ * @brief Reads a delta file.
+ * 
+ * @param filename The delta file.
+ * @param J Number of players of the instance the delta applies to.
+ * 
+ * @return InstanceDelta The changes (0-based player ids).
+ * @throws runtime_error If the file cannot be opened or a line is malformed.
+ */
+InstanceDelta load_delta(const string &filename, int J) {
+    ifstream in(filename);
+    if (!in.is_open()) throw runtime_error("Could not open file " + filename);
+
+    InstanceDelta delta;
+    string line;
+    int line_number = 0;
+    while (getline(in, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        istringstream ls(line);
+        string command;
+        if (!(ls >> command)) continue;
+
+        auto fail = [&](const string &message) {
+            return runtime_error(filename + ":" + to_string(line_number) + ": " + message);
+        };
+        auto player = [&]() {
+            int pid;
+            if (!(ls >> pid)) throw fail("expected a player id");
+            if (pid < 1 || pid > J + (int)delta.added_salaries.size()) throw fail("unknown player " + to_string(pid));
+            return pid - 1;
+        };
+        auto positive = [&]() {
+            int value;
+            if (!(ls >> value) || value < 1) throw fail("expected a positive number");
+            return value;
+        };
+
+        if (command == "budget") {
+            delta.budget = positive();
+        } else if (command == "add") {
+            delta.added_salaries.push_back(positive());
+        } else if (command == "salary") {
+            int pid = player();
+            delta.salaries[pid] = positive();
+        } else if (command == "remove") {
+            delta.removed.insert(player());
+        } else if (command == "conflict" || command == "unconflict") {
+            int a = player(), b = player();
+            if (a == b) throw fail("a player cannot conflict with itself");
+            delta.conflicts[{min(a, b), max(a, b)}] = command == "conflict";
+        } else {
+            throw fail("unknown change " + command);
+        }
+        string extra;
+        if (ls >> extra) throw fail("unexpected " + extra);
+    }
+    return delta;
+}
+
+/**
+ * @brief Builds the instance after a delta.
+ * 
+ * @param instance The instance before the delta.
+ * @param delta The changes.
+ * @param new_id Output: id after the delta of every player before it, added players
+ *               included (J + k for the k-th added player); -1 for the removed ones.
+ * 
+ * @return ProblemInstance The updated instance.
+ * @throws runtime_error If a salary exceeds the budget.
+ */
+ProblemInstance apply_delta(const ProblemInstance &instance, const InstanceDelta &delta, vector<int> &new_id) {
+    int total = instance.J + (int)delta.added_salaries.size();
+    ProblemInstance updated;
+    updated.B = delta.budget > 0 ? delta.budget : instance.B;
+    updated.memory_cap = instance.memory_cap;
+
+    new_id.assign(total, -1);
+    for (int pid = 0; pid < total; pid++) {
+        if (delta.removed.count(pid)) continue;
+        auto changed = delta.salaries.find(pid);
+        int salary = changed != delta.salaries.end() ? changed->second
+                   : pid < instance.J ? instance.players[pid].salary : delta.added_salaries[pid - instance.J];
+        if (salary > updated.B) {
+            throw runtime_error("Salary " + to_string(salary) + " of player " + to_string(pid + 1) + " exceeds the budget " + to_string(updated.B));
+        }
+        new_id[pid] = (int)updated.players.size();
+        updated.players.push_back({new_id[pid], salary});
+    }
+    updated.J = (int)updated.players.size();
+
+    // Kept conflicts, then the new ones (between players that stay)
+    vector<pair<int,int>> edges;
+    auto kept = [&](int a, int b) { return new_id[a] != -1 && new_id[b] != -1; };
+    for (int pid = 0; pid < instance.J; pid++) {
+        instance.adjacency->for_each_neighbor(pid, [&](int other) {
+            if (other <= pid || !kept(pid, other)) return;
+            auto change = delta.conflicts.find({pid, other});
+            if (change == delta.conflicts.end() || change->second) edges.push_back({new_id[pid], new_id[other]});
+        });
+    }
+    bool exists = false;
+    for (const auto &change : delta.conflicts) {
+        int a = change.first.first, b = change.first.second;
+        if (!change.second || !kept(a, b)) continue;
+        if (b < instance.J) {
+            exists = false;
+            instance.adjacency->for_each_neighbor(a, [&](int other) { exists |= other == b; });
+            if (exists) continue;
+        }
+        edges.push_back({new_id[a], new_id[b]});
+    }
+    updated.I = (int)edges.size();
+    build_adjacency(updated, edges);
+    return updated;
+}
+
+/**
+ * @brief Repairs a solution of the instance before a delta for the instance after it.
+ * 
+ * @details Every team keeps its players in order as long as they still fit its budget and
+ *          have no conflict with the ones kept; the others (and the new players, or any player
+ *          missing from the solution) are ejected and reinserted by First Fit, highest salary
+ *          first, opening new teams if needed. Teams left empty are dropped. Teams the delta
+ *          did not touch stay as they were.
+ * 
+ * @param previous Solution of the instance before the delta (any assignment; repeated players are ignored).
+ * @param updated The instance after the delta.
+ * @param new_id Player ids after the delta (see apply_delta).
+ * @param ejected Output: number of players reinserted.
+ * 
+ * @return vector<Team> A feasible solution of the updated instance.
+ */
+vector<Team> repair_solution(const vector<Team> &previous, const ProblemInstance &updated, const vector<int> &new_id,
+                             int &ejected) {
+    vector<char> placed(updated.J, 0);
+    vector<int> pending;
+    vector<Team> repaired;
+    for (const auto &team : previous) {
+        Team kept{updated.B, {}};
+        for (int pid : team.players) {
+            if (pid < 0 || pid >= (int)new_id.size() || new_id[pid] == -1 || placed[new_id[pid]]) continue;
+            const Player &p = updated.players[new_id[pid]];
+            placed[p.id] = 1;
+            if (can_add_to_team(kept, p, updated)) {
+                kept.players.push_back(p.id);
+                kept.remaining_budget -= p.salary;
+            } else {
+                pending.push_back(p.id);
+            }
+        }
+        if (!kept.players.empty()) repaired.push_back(move(kept));
+    }
+    for (int pid = 0; pid < updated.J; pid++) {
+        if (!placed[pid]) pending.push_back(pid);
+    }
+    ejected = (int)pending.size();
+
+    // First Fit, highest salary first
+    stable_sort(pending.begin(), pending.end(), [&](int a, int b) {
+        return updated.players[a].salary > updated.players[b].salary;
+    });
+    for (int pid : pending) {
+        const Player &p = updated.players[pid];
+        bool inserted = false;
+        for (auto &team : repaired) {
+            if (can_add_to_team(team, p, updated)) {
+                team.players.push_back(pid);
+                team.remaining_budget -= p.salary;
+                inserted = true;
+                break;
+            }
+        }
+        if (!inserted) repaired.push_back(Team{updated.B - p.salary, {pid}});
+    }
+    return repaired;
+}
+
+/**
+ * @brief Re-optimizes a solution after an instance delta: applies the delta, repairs the
+ *        solution and runs a short ILS from the repaired solution.
+ * 
+ * @param instance_file The instance before the delta.
+ * @param solution_file A solution of that instance.
+ * @param delta_file The delta.
+ * @param time_limit Seconds of the ILS after the repair.
+ * @param seed Seed of the ILS.
+ * @param params Search parameters.
+ * @param max_iterations Also stop after this many iterations (0 = time limit only).
+ * @param save_instance Where the updated instance is written (empty = not written).
+ * @param save_solution Where the new solution is written (empty = not written).
+ * @param memory_cap Bytes the conflict graph may use.
+ * 
+ * @return int Exit code.
+ */
+int run_update(const string &instance_file, const string &solution_file, const string &delta_file, double time_limit,
+               uint64_t seed, const IlsParams &params, int max_iterations, const string &save_instance,
+               const string &save_solution, size_t memory_cap) {
+    auto start = chrono::high_resolution_clock::now();
+    auto elapsed_ms = [&]() {
+        return chrono::duration_cast<chrono::duration<double, milli>>(chrono::high_resolution_clock::now() - start).count();
+    };
+    ProblemInstance instance = read_instance(instance_file, memory_cap);
+    vector<Team> previous = load_solution(solution_file, instance);
+    InstanceDelta delta = load_delta(delta_file, instance.J);
+    double load_ms = elapsed_ms();
+
+    auto repair_start = chrono::high_resolution_clock::now();
+    vector<int> new_id;
+    ProblemInstance updated = apply_delta(instance, delta, new_id);
+    int ejected = 0;
+    vector<Team> repaired = repair_solution(previous, updated, new_id, ejected);
+    LOG(LOG_INFO, "Delta: " << delta.added_salaries.size() << " players added, " << delta.removed.size() << " removed, "
+         << delta.salaries.size() << " salaries and " << delta.conflicts.size() << " conflicts changed"
+         << (delta.budget > 0 ? ", new budget " + to_string(delta.budget) : string()) << ".\n"
+         << "Repaired solution has " << repaired.size() << " teams (" << previous.size() << " before), "
+         << ejected << " players reinserted, in " << elapsed_ms() - load_ms << " ms.\n");
+
+    Rng rng(seed);
+    int iterations = 0;
+    Deadline deadline(repair_start, time_limit);
+    vector<Team> best = ils_search(updated, repaired, repaired, rng, params, iterations, deadline,
+        [&]() { return max_iterations > 0 && iterations >= max_iterations; },
+        [&](const vector<Team> &solution) {
+            LOG(LOG_INFO, "(" << elapsed_ms() - load_ms << " ms) New solution found in LS: " << solution.size() << " teams.\n");
+        },
+        [](const vector<Team> &, const vector<Team> &) {});
+
+    string error;
+    if (!validate_solution(best, updated, error)) throw runtime_error("Internal error, invalid solution: " + error);
+    LOG(LOG_DEBUG, format_solution(best));
+    LOG(LOG_INFO, "Re-optimization finished after " << iterations << " iterations in " << elapsed_ms() - load_ms
+         << " ms.\nFinal solution uses " << best.size() << " teams.\n");
+    if (!save_instance.empty()) {
+        write_file_atomically(save_instance, [&](ostream &out) { write_instance(out, updated); });
+        LOG(LOG_INFO, "Updated instance saved to " << save_instance << "\n");
+    }
+    if (!save_solution.empty()) {
+        write_file_atomically(save_solution, [&](ostream &out) { write_solution(out, best); });
+        LOG(LOG_INFO, "Best solution saved to " << save_solution << "\n");
+    }
+    return 0;
+}
+
+// ================= Server ================= //
+/*
+ * Line protocol of the server mode (one command per line, one reply per line):
+ *   load <instance_id> <path> [reduce]            -> ok loaded <instance_id> <J> <I> <B>
+ *   unload <instance_id>                          -> ok unloaded <instance_id>
+ *   list                                          -> ok instances <instance_id>...
+ *   solve <request_id> <instance_id> <seed> <time> [<ratio>]
+ *                                                 -> ok queued <request_id>
+ *                                                    improved <request_id> <elapsed_s> <teams>  (streamed)
+ *                                                    solution <request_id> <p,p,...> <p,...> ...
+ *                                                    done <request_id> <teams> <iterations> <elapsed_s>
+ *   cancel <request_id>                           -> ok cancelling <request_id>
+ *   quit                                          -> closes the connection
+ *   shutdown                                      -> stops the server
+ * Errors are reported as "error <message>". Player ids are 1-based, as in the instance file.
+ */
+
+/**
+ * @brief Formats the teams of a solution for a protocol line: teams separated by spaces,
+ *        players of a team separated by commas (1-based ids).
+ * 
+ * @param solution The solution.
+ * 
+ * @return string The teams, each preceded by a space.
+ */
+string format_teams_line(const vector<Team> &solution) {
+    string line;
+    for (const auto &team : solution) {
+        line += " ";
+        for (size_t k = 0; k < team.players.size(); k++) {
+            line += (k ? "," : "") + to_string(team.players[k] + 1);
+        }
+    }
+    return line;
+}
+
+/**
+ * @brief Reads the teams written by format_teams_line and validates the solution.
+ * 
+ * @param in Stream positioned at the first team.
+ * @param instance The problem instance the solution belongs to.
+ * 
+ * @return vector<Team> The solution read, with its team budgets.
+ * @throws runtime_error If a token is malformed or the solution is not feasible.
+ */
+vector<Team> parse_teams_line(istream &in, const ProblemInstance &instance) {
+    vector<Team> solution;
+    string token;
+    while (in >> token) {
+        Team team;
+        team.remaining_budget = instance.B;
+        stringstream players(token);
+        string id;
+        while (getline(players, id, ',')) {
+            int pid = atoi(id.c_str());
+            if (pid < 1 || pid > instance.J) throw runtime_error("player " + id + " out of range");
+            team.players.push_back(pid - 1);
+            team.remaining_budget -= instance.players[pid - 1].salary;
+        }
+        solution.push_back(move(team));
+    }
+    string error;
+    if (!validate_solution(solution, instance, error)) throw runtime_error("invalid solution: " + error);
+    return solution;
+}
+
+/**
+ * @brief Reads the next newline-terminated line from a file descriptor.
+ * 
+ * @param fd File descriptor to read from.
+ * @param buffer Bytes read but not consumed yet (kept between calls).
+ * @param line Output: the line without the newline (at the end of the input, the unterminated rest).
+ * 
+ * @return bool false once the input ended and nothing is left.
+ */
+bool read_line(int fd, string &buffer, string &line) {
+    char chunk[4096];
+    while (true) {
+        size_t newline = buffer.find('\n');
+        if (newline != string::npos) {
+            line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            return true;
+        }
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n <= 0) {
+            if (buffer.empty()) return false;
+            line = move(buffer);
+            buffer.clear();
+            return true;
+        }
+        buffer.append(chunk, n);
+    }
+}
+
+struct ResidentInstance {
+    ProblemInstance instance; // instance the search works on
+    bool reduced = false;
+    Reduction reduction; // used to map solutions back when reduced
+};
+
+struct Connection {
+    int fd; // output file descriptor
+    bool owns_fd; // fd is closed with the connection, after the last job writing to it is gone
+    mutex write_mutex;
+    atomic<bool> closed{false};
+
+    explicit Connection(int fd, bool owns_fd = false) : fd(fd), owns_fd(owns_fd) {}
+    ~Connection() {
+        if (owns_fd) close(fd);
+    }
+
+    /**
+     * @brief Stops the output; a send_line in progress finishes first, later ones are dropped.
+     * 
+     * @return void
+     */
+    void close_output() {
+        lock_guard<mutex> lock(write_mutex);
+        closed = true;
+    }
+
+    /**
+     * @brief Sends one line to the client (thread safe).
+     * 
+     * @param line The line, without the trailing newline.
+     * 
+     * @return void
+     */
+    void send_line(const string &line) {
+        if (closed) return;
+        lock_guard<mutex> lock(write_mutex);
+        if (closed) return; // closed while waiting for the lock
+        string data = line + "\n";
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = fd == STDOUT_FILENO ? write(fd, data.data() + sent, data.size() - sent)
+                                            : send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                closed = true;
+                return;
+            }
+            sent += n;
+        }
+    }
+};
+
+struct SolveJob {
+    string request_id;
+    shared_ptr<const ResidentInstance> resident;
+    int seed;
+    double time;
+    IlsParams params;
+    Constructor constructor = CONSTRUCT_FIRST_FIT;
+    int max_iterations = 0; // 0 = time limit only
+    shared_ptr<Connection> connection;
+    shared_ptr<atomic<bool>> cancelled;
+};
+
+/**
+ * @brief Parses one option of a solve request.
+ * 
+ * @param option "name=value", with the names of the ils_time options: ratio (perturbation
+ *               ratio), stagnation, pool_interval, alns (0/1), acceptance, sa_temperature,
+ *               sa_cooling, lahc_length, exact_interval, exact_nodes, matching (0/1),
+ *               constructor and max_iterations.
+ * @param job The request (changed in place).
+ * 
+ * @return void
+ * @throws runtime_error If the option is unknown or malformed.
+ */
+void parse_solve_option(const string &option, SolveJob &job) {
+    size_t eq = option.find('=');
+    if (eq == string::npos) throw runtime_error("expected name=value, got " + option);
+    string name = option.substr(0, eq), value = option.substr(eq + 1);
+    IlsParams &params = job.params;
+    if (name == "ratio") params.perturbation_ratio = stod(value);
+    else if (name == "stagnation") params.stagnation_limit = max(1, stoi(value));
+    else if (name == "pool_interval") params.pool_interval = stoi(value);
+    else if (name == "alns") params.alns = stoi(value) != 0;
+    else if (name == "acceptance") params.acceptance = parse_acceptance(value);
+    else if (name == "sa_temperature") params.sa_temperature = stod(value);
+    else if (name == "sa_cooling") params.sa_cooling = stod(value);
+    else if (name == "lahc_length") params.lahc_length = stoi(value);
+    else if (name == "exact_interval") params.exact_interval = stoi(value);
+    else if (name == "exact_nodes") params.exact_nodes = stoll(value);
+    else if (name == "matching") params.matching = stoi(value) != 0;
+    else if (name == "constructor") job.constructor = parse_constructor(value);
+    else if (name == "max_iterations") job.max_iterations = stoi(value);
+    else throw runtime_error("unknown option " + name);
+}
+
+class SolverServer {
+public:
+    size_t memory_cap = DEFAULT_MEMORY_CAP; // for the conflict graph of each loaded instance
+
+    explicit SolverServer(size_t workers) {
+        for (size_t w = 0; w < workers; w++) threads.emplace_back([this]() { worker(); });
+    }
+
+    ~SolverServer() { stop(false); }
+
+    /**
+     * @brief Stops the workers.
+     * 
+     * @param cancel_running If true, queued jobs are dropped and running jobs are cancelled;
+     *                       otherwise every queued job is finished first.
+     * 
+     * @return void
+     */
+    void stop(bool cancel_running) {
+        {
+            lock_guard<mutex> lock(state_mutex);
+            stopping = true;
+            if (cancel_running) {
+                queue.clear();
+                for (auto &entry : running) *entry.second = true;
+            }
+        }
+        queue_cv.notify_all();
+        for (auto &t : threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    bool shutdown_requested() const { return shutdown_flag; }
+
+    /**
+     * @brief Executes one command line from a client.
+     * 
+     * @param line The command line.
+     * @param connection Client that sent the command (receives the replies).
+     * 
+     * @return bool false if the connection should be closed.
+     */
+    bool handle(const string &line, const shared_ptr<Connection> &connection) {
+        istringstream in(line);
+        string command;
+        if (!(in >> command)) return true;
+
+        try {
+            if (command == "load") {
+                string id, path, option;
+                if (!(in >> id >> path)) throw runtime_error("usage: load <instance_id> <path> [reduce]");
+                in >> option;
+                auto resident = make_shared<ResidentInstance>();
+                resident->instance = read_instance(path, memory_cap);
+                if (option == "reduce") {
+                    resident->reduced = true;
+                    resident->reduction = reduce_instance(resident->instance);
+                    resident->instance = move(resident->reduction.reduced);
+                }
+                {
+                    lock_guard<mutex> lock(state_mutex);
+                    instances[id] = resident;
+                }
+                connection->send_line("ok loaded " + id + " " + to_string(resident->instance.J) + " " +
+                                      to_string(resident->instance.I) + " " + to_string(resident->instance.B));
+            } else if (command == "unload") {
+                string id;
+                in >> id;
+                lock_guard<mutex> lock(state_mutex);
+                if (!instances.erase(id)) throw runtime_error("unknown instance " + id);
+                connection->send_line("ok unloaded " + id);
+            } else if (command == "list") {
+                string reply = "ok instances";
+                lock_guard<mutex> lock(state_mutex);
+                for (const auto &entry : instances) reply += " " + entry.first;
+                connection->send_line(reply);
+            } else if (command == "solve") {
+                SolveJob job;
+                string instance_id, option;
+                if (!(in >> job.request_id >> instance_id >> job.seed >> job.time)) {
+                    throw runtime_error("usage: solve <request_id> <instance_id> <seed> <time> [<ratio>] [name=value...]");
+                }
+                for (bool first = true; in >> option; first = false) {
+                    if (first && option.find('=') == string::npos) option = "ratio=" + option; // positional ratio
+                    try {
+                        parse_solve_option(option, job);
+                    } catch (const invalid_argument &) {
+                        throw runtime_error("invalid value in " + option);
+                    } catch (const out_of_range &) {
+                        throw runtime_error("invalid value in " + option);
+                    }
+                }
+                job.connection = connection;
+                job.cancelled = make_shared<atomic<bool>>(false);
+                {
+                    lock_guard<mutex> lock(state_mutex);
+                    auto it = instances.find(instance_id);
+                    if (it == instances.end()) throw runtime_error("unknown instance " + instance_id);
+                    if (running.count(job.request_id)) throw runtime_error("request " + job.request_id + " already exists");
+                    job.resident = it->second;
+                    running[job.request_id] = job.cancelled;
+                }
+                // Reply before queueing, so that it comes before any streamed line
+                connection->send_line("ok queued " + job.request_id);
+                {
+                    lock_guard<mutex> lock(state_mutex);
+                    queue.push_back(job);
+                }
+                queue_cv.notify_one();
+            } else if (command == "cancel") {
+                string id;
+                in >> id;
+                lock_guard<mutex> lock(state_mutex);
+                auto it = running.find(id);
+                if (it == running.end()) throw runtime_error("unknown request " + id);
+                *it->second = true;
+                connection->send_line("ok cancelling " + id);
+            } else if (command == "quit") {
+                return false;
+            } else if (command == "shutdown") {
+                shutdown_flag = true;
+                return false;
+            } else {
+                throw runtime_error("unknown command " + command);
+            }
+        } catch (const exception &ex) {
+            connection->send_line(string("error ") + ex.what());
+        }
+        return true;
+    }
+
+private:
+    mutex state_mutex;
+    condition_variable queue_cv;
+    deque<SolveJob> queue;
+    map<string, shared_ptr<const ResidentInstance>> instances;
+    map<string, shared_ptr<atomic<bool>>> running; // queued or running requests
+    vector<thread> threads;
+    bool stopping = false;
+    atomic<bool> shutdown_flag{false};
+
+    /**
+     * @brief Worker loop: takes jobs from the queue until the server stops.
+     * 
+     * @return void
+     */
+    void worker() {
+        while (true) {
+            SolveJob job;
+            {
+                unique_lock<mutex> lock(state_mutex);
+                queue_cv.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                job = move(queue.front());
+                queue.pop_front();
+            }
+            solve(job);
+            lock_guard<mutex> lock(state_mutex);
+            running.erase(job.request_id);
+        }
+    }
+
+    /**
+     * @brief Runs the ILS for one request, streaming the improvements to its client.
+     * 
+     * @param job The request.
+     * 
+     * @return void
+     */
+    void solve(const SolveJob &job) {
+        auto start = chrono::high_resolution_clock::now();
+        auto elapsed = [&]() {
+            return chrono::duration_cast<chrono::duration<double>>(chrono::high_resolution_clock::now() - start).count();
+        };
+        const ResidentInstance &resident = *job.resident;
+        size_t fixed_teams = resident.reduced ? resident.reduction.fixed_teams.size() : 0;
+
+        Rng rng(job.seed);
+        vector<Team> initial = construct_initial_solution(resident.instance, rng, job.constructor);
+        job.connection->send_line("improved " + job.request_id + " " + to_string(elapsed()) + " " +
+                                  to_string(initial.size() + fixed_teams));
+
+        int iterations = 0;
+        Deadline deadline(start, job.time);
+        vector<Team> best = ils_search(resident.instance, initial, initial, rng, job.params, iterations, deadline,
+            [&]() {
+                return *job.cancelled || job.connection->closed || (job.max_iterations > 0 && iterations >= job.max_iterations);
+            },
+            [&](const vector<Team> &solution) {
+                job.connection->send_line("improved " + job.request_id + " " + to_string(elapsed()) + " " +
+                                          to_string(solution.size() + fixed_teams));
+            },
+            [](const vector<Team> &, const vector<Team> &) {});
+        if (resident.reduced) best = expand_solution(best, resident.reduction);
+
+        job.connection->send_line("solution " + job.request_id + format_teams_line(best));
+        job.connection->send_line("done " + job.request_id + " " + to_string(best.size()) + " " +
+                                  to_string(iterations) + " " + to_string(elapsed()));
+    }
+};
+
+/**
+ * @brief Reads newline-terminated commands from a file descriptor and hands them to the server.
+ * 
+ * @param server The server.
+ * @param in_fd File descriptor to read from.
+ * @param connection Client connection the replies go to.
+ * 
+ * @return void
+ */
+void serve_connection(SolverServer &server, int in_fd, const shared_ptr<Connection> &connection) {
+    string buffer, line;
+    while (read_line(in_fd, buffer, line)) {
+        if (!server.handle(line, connection)) return;
+    }
+}
+
+/**
+ * @brief Runs the server mode, on stdin/stdout or on a Unix domain socket.
+ * 
+ * @details On stdin/stdout the server finishes the queued requests after the end of the
+ *          input. On a socket every client gets its own connection; requests of a client
+ *          that disconnects are cancelled, and "shutdown" stops the server.
+ * 
+ * @param socket_path Path of the Unix domain socket (empty for stdin/stdout).
+ * @param workers Number of worker threads.
+ * @param memory_cap Bytes the conflict graph of each loaded instance may use.
+ * 
+ * @return int Exit code.
+ */
+int run_server(const string &socket_path, size_t workers, size_t memory_cap) {
+    signal(SIGPIPE, SIG_IGN);
+    logger.output = stderr; // stdout carries the replies in stdin/stdout mode
+    SolverServer server(workers);
+    server.memory_cap = memory_cap;
+
+    if (socket_path.empty()) {
+        auto connection = make_shared<Connection>(STDOUT_FILENO);
+        serve_connection(server, STDIN_FILENO, connection);
+        server.stop(server.shutdown_requested());
+        return 0;
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (listen_fd < 0 || socket_path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Error: Could not create socket " << socket_path << "\n";
+        return 1;
+    }
+    socket_path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    unlink(socket_path.c_str());
+    if (bind(listen_fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 16) != 0) {
+        cerr << "Error: Could not listen on socket " << socket_path << "\n";
+        close(listen_fd);
+        return 1;
+    }
+    cerr << "Listening on " << socket_path << " with " << workers << " workers.\n";
+
+    // Each client is served by its own thread; shutdown closes the listening socket.
+    // The threads of the clients that left are joined at every new connection
+    list<pair<thread, shared_ptr<atomic<bool>>>> clients; // (thread, finished)
+    while (!server.shutdown_requested()) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) break;
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (!*it->second) {
+                ++it;
+                continue;
+            }
+            it->first.join();
+            it = clients.erase(it);
+        }
+        auto finished = make_shared<atomic<bool>>(false);
+        clients.emplace_back(thread([&server, fd, listen_fd, finished]() {
+            // The connection closes fd once the jobs of the client release it, so a job can
+            // never write to a descriptor already reused by another client
+            auto connection = make_shared<Connection>(fd, true);
+            serve_connection(server, fd, connection);
+            connection->close_output();
+            if (server.shutdown_requested()) shutdown(listen_fd, SHUT_RDWR);
+            *finished = true;
+        }), finished);
+    }
+    server.stop(true);
+    for (auto &client : clients) client.first.join();
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    return 0;
+}
+
+// ================= Cooperative Search ================= //
+/*
+ * Line protocol between the coordinator (--coordinate) and its workers (--work), over TCP:
+ *   worker:      hello <fingerprint>           -> welcome <seconds_left>
+ *                                                 incumbent <p,p,...> ...  (if there is one already)
+ *   worker:      solution <p,p,...> ...        new best of the worker
+ *   worker:      restart <p,p,...> ...         the worker stagnated: its best, asking for a new start
+ *                                              -> start <p,p,...> ...      (recombined from the elite teams)
+ *   coordinator: incumbent <p,p,...> ...       new global best, sent to the other workers
+ *   coordinator: stop                          time limit, target or lower bound reached
+ * Errors are reported as "error <message>" and close the connection. Teams are written by
+ * format_teams_line. Every solution received is validated, kept by the coordinator (and
+ * saved, with --save_solution) and harvested into its TeamPool, so a worker that crashes
+ * loses nothing it had reported.
+ */
+constexpr int DEFAULT_COORDINATOR_PORT = 7411;
+constexpr const char *DEFAULT_COORDINATOR_BIND = "127.0.0.1"; // loopback only: the protocol has no authentication
+constexpr int DEFAULT_RESTART_INTERVAL = 50; // worker iterations without a new best before asking for a new start
+constexpr double COORDINATOR_GRACE = 1.0; // seconds the workers get to disconnect after "stop"
+
+/**
+ * @brief Hashes the budget, salaries and conflicts of an instance (FNV-1a), so that a worker
+ *        can check that it loaded the same instance as the coordinator.
+ * 
+ * @param instance The problem instance.
+ * 
+ * @return uint64_t The fingerprint.
+ */
+uint64_t instance_fingerprint(const ProblemInstance &instance) {
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&h](uint64_t value) {
+        h ^= value;
+        h *= 1099511628211ULL;
+    };
+    mix(instance.B);
+    mix(instance.J);
+    for (const auto &player : instance.players) mix(player.salary);
+    for (int pid = 0; pid < instance.J; pid++) {
+        instance.adjacency->for_each_neighbor(pid, [&](int other) {
+            if (other > pid) mix((uint64_t)pid << 32 | (uint32_t)other);
+        });
+    }
+    return h;
+}
+
+class Coordinator {
+public:
+    /**
+     * @param instance The problem instance shared with the workers.
+     * @param deadline Time limit of the cooperative search.
+     * @param target Stop once the best solution has at most this many teams (0 = no target).
+     * @param save_file Where every new best solution is saved (empty = not saved).
+     * @param seed Seed of the pool recombinations sent to the workers.
+     */
+    Coordinator(const ProblemInstance &instance, const Deadline &deadline, int target, const string &save_file,
+                uint64_t seed)
+        : instance(instance), deadline(deadline), target(target), save_file(save_file),
+          fingerprint(instance_fingerprint(instance)), rng(seed) {
+        stop_teams = max(target, reduce_instance(instance).lower_bound);
+    }
+
+    bool finished() {
+        lock_guard<mutex> lock(state_mutex);
+        return done;
+    }
+
+    /**
+     * @brief Stops the search if the time limit is reached.
+     * 
+     * @return bool true if the search is finished.
+     */
+    bool check_time() {
+        vector<shared_ptr<Connection>> stopped;
+        {
+            lock_guard<mutex> lock(state_mutex);
+            if (done) return true;
+            if (!deadline.expired_now()) return false;
+            stopped = finish("Time limit reached");
+        }
+        send_all(stopped, "stop");
+        return true;
+    }
+
+    /**
+     * @brief Waits for the workers to disconnect after "stop", then closes the remaining connections.
+     * 
+     * @return void
+     */
+    void close_workers() {
+        unique_lock<mutex> lock(state_mutex);
+        workers_cv.wait_for(lock, chrono::duration<double>(COORDINATOR_GRACE), [this]() { return workers.empty(); });
+        for (const auto &worker : workers) shutdown(worker->fd, SHUT_RDWR);
+    }
+
+    vector<Team> best_solution() {
+        lock_guard<mutex> lock(state_mutex);
+        return best;
+    }
+
+    int worker_count() const { return workers_seen; }
+
+    /**
+     * @brief Serves one worker until it disconnects.
+     * 
+     * @param fd Socket of the worker.
+     * 
+     * @return void
+     */
+    void serve(int fd) {
+        auto connection = make_shared<Connection>(fd);
+        string buffer, line;
+        int id = 0;
+        try {
+            if (!read_line(fd, buffer, line)) return;
+            istringstream hello(line);
+            string command;
+            uint64_t worker_fingerprint = 0;
+            if (!(hello >> command >> worker_fingerprint) || command != "hello") throw runtime_error("expected hello <fingerprint>");
+            if (worker_fingerprint != fingerprint) throw runtime_error("the worker loaded a different instance");
+            {
+                lock_guard<mutex> lock(state_mutex);
+                if (done) throw runtime_error("the search is finished");
+                id = ++workers_seen;
+                double left = max(0.0, (deadline.end_ns - coarse_now_ns()) / 1e9);
+                connection->send_line("welcome " + to_string(left));
+                if (!best.empty()) connection->send_line("incumbent" + format_teams_line(best));
+                workers.push_back(connection);
+            }
+            LOG(LOG_INFO, "(" << elapsed() << ") Worker " << id << " connected.\n");
+
+            while (read_line(fd, buffer, line)) {
+                istringstream in(line);
+                if (!(in >> command)) continue;
+                if (command == "solution") {
+                    offer(parse_teams_line(in, instance), id, connection);
+                } else if (command == "restart") {
+                    offer(parse_teams_line(in, instance), id, connection);
+                    vector<Team> start;
+                    {
+                        lock_guard<mutex> lock(state_mutex);
+                        start = pool.teams.empty() ? best : recombine_pool(pool, instance, rng);
+                    }
+                    connection->send_line("start" + format_teams_line(start));
+                } else {
+                    throw runtime_error("unknown command " + command);
+                }
+            }
+        } catch (const exception &ex) {
+            connection->send_line(string("error ") + ex.what());
+            LOG(LOG_INFO, "(" << elapsed() << ") " << (id ? "Worker " + to_string(id) : string("Rejected worker")) << ": " << ex.what() << "\n");
+        }
+
+        lock_guard<mutex> lock(state_mutex);
+        auto it = find(workers.begin(), workers.end(), connection);
+        if (it != workers.end()) {
+            workers.erase(it);
+            if (!done) LOG(LOG_INFO, "(" << elapsed() << ") Worker " << id << " disconnected.\n");
+        }
+        workers_cv.notify_all();
+    }
+
+private:
+    const ProblemInstance &instance;
+    Deadline deadline;
+    int target;
+    string save_file;
+    uint64_t fingerprint;
+    int stop_teams; // target or lower bound
+    int64_t start_ns = coarse_now_ns();
+
+    mutex state_mutex;
+    condition_variable workers_cv;
+    vector<shared_ptr<Connection>> workers; // connected workers
+    int workers_seen = 0;
+    bool done = false;
+    vector<Team> best;
+    TeamPool pool; // elite teams of every solution received
+    Rng rng;
+
+    double elapsed() const { return (coarse_now_ns() - start_ns) / 1e9; }
+
+    /**
+     * @brief Sends a line to some workers. Called without state_mutex: a worker with a full
+     *        socket buffer blocks only the caller.
+     * 
+     * @param to The workers.
+     * @param line The line.
+     * 
+     * @return void
+     */
+    static void send_all(const vector<shared_ptr<Connection>> &to, const string &line) {
+        for (const auto &worker : to) worker->send_line(line);
+    }
+
+    /**
+     * @brief Finishes the search (with state_mutex held).
+     * 
+     * @param reason Logged reason.
+     * 
+     * @return vector<shared_ptr<Connection>> The workers to send "stop" to, after releasing state_mutex.
+     */
+    vector<shared_ptr<Connection>> finish(const string &reason) {
+        done = true;
+        LOG(LOG_INFO, "(" << elapsed() << ") " << reason << ": stopping " << workers.size() << " workers.\n");
+        return workers;
+    }
+
+    /**
+     * @brief Takes a solution reported by a worker: keeps its elite teams and, if it is a new
+     *        global best, saves it and sends it to the other workers.
+     * 
+     * @param solution The validated solution.
+     * @param id Number of the worker.
+     * @param from Connection of the worker.
+     * 
+     * @return void
+     */
+    void offer(const vector<Team> &solution, int id, const shared_ptr<Connection> &from) {
+        // The lines are sent after releasing state_mutex; workers keep the smallest incumbent
+        // they receive, so two offers racing to send is harmless
+        vector<shared_ptr<Connection>> others, stopped;
+        string incumbent;
+        {
+            lock_guard<mutex> lock(state_mutex);
+            harvest_teams(pool, solution, instance);
+            if (!best.empty() && solution.size() >= best.size()) return;
+
+            best = solution;
+            LOG(LOG_INFO, "(" << elapsed() << ") New solution found by worker " << id << ": " << best.size() << " teams.\n");
+            if (!save_file.empty()) {
+                write_file_atomically(save_file, [&](ostream &out) { write_solution(out, best); });
+            }
+            if (done) return;
+            for (const auto &worker : workers) {
+                if (worker != from) others.push_back(worker);
+            }
+            incumbent = "incumbent" + format_teams_line(best);
+            if ((int)best.size() <= stop_teams) {
+                stopped = finish((stop_teams == target ? "Target of " : "Lower bound of ") + to_string(stop_teams) + " teams reached");
+            }
+        }
+        send_all(others, incumbent);
+        send_all(stopped, "stop");
+    }
+};
+
+/**
+ * @brief Runs the coordinator of a cooperative search: listens on a TCP port, keeps the
+ *        global best solution of the workers and stops them at the time limit, at the
+ *        target or at the lower bound of reduce_instance.
+ * 
+ * @param instance_file The instance the workers solve.
+ * @param time_limit Seconds of the cooperative search, counted from start.
+ * @param port TCP port to listen on.
+ * @param bind_address Local address to listen on. The protocol has no authentication, so the
+ *                     default is the loopback; "0.0.0.0" accepts workers from any host.
+ * @param target Stop once the best solution has at most this many teams (0 = no target).
+ * @param save_file Where every new best solution is saved (empty = not saved).
+ * @param seed Seed of the pool recombinations.
+ * @param memory_cap Bytes the conflict graph may use.
+ * 
+ * @return int Exit code.
+ */
+int run_coordinator(const string &instance_file, double time_limit, int port, const string &bind_address, int target,
+                    const string &save_file, uint64_t seed, size_t memory_cap) {
+    signal(SIGPIPE, SIG_IGN);
+    auto start = chrono::high_resolution_clock::now();
+    ProblemInstance instance = read_instance(instance_file, memory_cap);
+    Coordinator coordinator(instance, Deadline(start, time_limit), target, save_file, seed);
+
+    addrinfo hints{}, *found = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(bind_address.c_str(), to_string(port).c_str(), &hints, &found) != 0) {
+        cerr << "Error: Unknown address " << bind_address << "\n";
+        return 1;
+    }
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    bool listening = listen_fd >= 0 && setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == 0 &&
+                     bind(listen_fd, found->ai_addr, found->ai_addrlen) == 0 && listen(listen_fd, 64) == 0;
+    freeaddrinfo(found);
+    if (!listening) {
+        cerr << "Error: Could not listen on " << bind_address << ":" << port << "\n";
+        if (listen_fd >= 0) close(listen_fd);
+        return 1;
+    }
+    LOG(LOG_INFO, "Coordinating " << instance_file << " on " << bind_address << ":" << port << " for " << time_limit << " s.\n");
+
+    // Every worker is served by its own thread; the loop wakes up regularly to check the time
+    vector<thread> workers;
+    vector<int> fds;
+    while (!coordinator.check_time()) {
+        pollfd pfd{listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) continue;
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        fds.push_back(fd);
+        workers.emplace_back([&coordinator, fd]() { coordinator.serve(fd); });
+    }
+    close(listen_fd);
+    coordinator.close_workers();
+    for (auto &t : workers) t.join();
+    for (int fd : fds) close(fd);
+
+    vector<Team> best = coordinator.best_solution();
+    double seconds = chrono::duration_cast<chrono::duration<double>>(chrono::high_resolution_clock::now() - start).count();
+    LOG(LOG_INFO, "\nCooperative search finished after " << seconds << " s with " << coordinator.worker_count() << " workers.\n");
+    if (best.empty()) {
+        LOG(LOG_INFO, "No solution was reported.\n");
+        return 1;
+    }
+    LOG(LOG_DEBUG, format_solution(best));
+    LOG(LOG_INFO, "Final solution uses " << best.size() << " teams.\n");
+    if (!save_file.empty()) LOG(LOG_INFO, "Best solution saved to " << save_file << "\n");
+    return 0;
+}
+
+/**
+ * @brief Opens a TCP connection to host:port.
  * 
- * @param team The team to insert the player.
- * @param player The player to be tested for insertion.
+ * @param address The address, as host:port.
  * 
- * @return true If the player can be added without exceeding budget or causing conflicts.
- * @return false Otherwise.
+ * @return int The socket.
+ * @throws runtime_error If the address is malformed or no connection can be made.
  */
-bool can_add_to_team(const Team &team, const Player &player) {
-    if (player.salary > team.remaining_budget) return false;
+int connect_tcp(const string &address) {
+    size_t colon = address.rfind(':');
+    if (colon == string::npos) throw runtime_error("expected host:port, got " + address);
+    string host = address.substr(0, colon), port = address.substr(colon + 1);
 
-    // Check conflicts with players already in the team
-    for (int teammate_id : team.players) {
-        // If teammate is in player's conflict list, return false
-        for (int conflict : player.conflicts) {
-            if (conflict == teammate_id) {
-                return false;
-            }
+    addrinfo hints{}, *found = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0) throw runtime_error("unknown host " + host);
+    int fd = -1;
+    for (addrinfo *a = found; a && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
         }
     }
-    return true;
+    freeaddrinfo(found);
+    if (fd < 0) throw runtime_error("could not connect to " + address);
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    return fd;
 }
 
 /**
- * @brief Constructs an initial solution using First Fit Decreasing (FFD).
+ * @brief Runs a worker of a cooperative search: an ILS that reports its new best solutions
+ *        to the coordinator and continues from the better incumbents it receives.
  * 
- * @param instance The problem instance with players and constraints.
+ * @details The ILS is interrupted between iterations whenever the coordinator sends a
+ *          solution: an incumbent with fewer teams than the worker's best replaces both its
+ *          best and current solutions; a "start" (the reply to a restart request, sent after
+ *          restart_interval iterations without a new best) replaces the current solution.
+ *          The worker stops on "stop", when the coordinator disconnects or at the time limit
+ *          given in the welcome.
  * 
- * @return vector<Team> A set of initial teams with assigned players.
+ * @param address The coordinator, as host:port.
+ * @param instance_file The instance (the same file as the coordinator's).
+ * @param seed Seed of the worker's random number generator.
+ * @param params Search parameters.
+ * @param restart_interval Iterations without a new best before asking for a new start (0 = never).
+ * @param memory_cap Bytes the conflict graph may use.
+ * 
+ * @return int Exit code.
  */
-vector<Team> construct_initial_solution(const ProblemInstance &instance, mt19937 rng) {
-
-    // Create a player ids list
-    vector<int> order(instance.J);
-    iota(order.begin(), order.end(), 0); 
-
-    // Shuffle players ids
-    std::shuffle(order.begin(), order.end(), rng);
-
-    vector<Team> teams;
+int run_worker(const string &address, const string &instance_file, uint64_t seed, const IlsParams &params,
+               int restart_interval, size_t memory_cap) {
+    signal(SIGPIPE, SIG_IGN);
+    auto start = chrono::high_resolution_clock::now();
+    ProblemInstance instance = read_instance(instance_file, memory_cap);
+    int fd = connect_tcp(address);
+    auto connection = make_shared<Connection>(fd);
 
-    // Place players one by one (First Fit Decreasing)
-    for (int pid : order) {
-        const Player &p = instance.players[pid];
-        bool placed = false;
+    // Handshake
+    connection->send_line("hello " + to_string(instance_fingerprint(instance)));
+    string buffer, line, command;
+    double time_limit = 0;
+    if (!read_line(fd, buffer, line)) throw runtime_error("the coordinator closed the connection");
+    istringstream welcome(line);
+    welcome >> command;
+    if (command == "error") throw runtime_error("coordinator: " + line.substr(min(line.size(), (size_t)6)));
+    if (command != "welcome" || !(welcome >> time_limit)) throw runtime_error("unexpected reply: " + line);
+    Deadline deadline(chrono::high_resolution_clock::now(), time_limit);
+    LOG(LOG_INFO, "Connected to " << address << " (" << time_limit << " s left).\n");
 
-        // Try to put on the first viable team
-        for (auto &team : teams) {
-            if (can_add_to_team(team, p)) {
-                team.players.push_back(p.id);
-                team.remaining_budget -= p.salary;
-                placed = true;
+    // Solutions sent by the coordinator wait here until the ILS is interrupted
+    mutex inbox_mutex;
+    vector<Team> incumbent, restart;
+    atomic<bool> inbox{false}, stop{false};
+    thread reader([&]() {
+        string buffer2 = buffer, message;
+        while (read_line(fd, buffer2, message)) {
+            istringstream in(message);
+            string kind;
+            in >> kind;
+            try {
+                if (kind == "incumbent" || kind == "start") {
+                    vector<Team> solution = parse_teams_line(in, instance);
+                    lock_guard<mutex> lock(inbox_mutex);
+                    if (kind == "start") {
+                        restart = move(solution);
+                    } else if (incumbent.empty() || solution.size() < incumbent.size()) {
+                        incumbent = move(solution);
+                    }
+                    inbox = true;
+                } else if (kind == "stop") {
+                    break;
+                } else if (kind == "error") {
+                    cerr << "Coordinator: " << message << "\n";
+                    break;
+                }
+            } catch (const exception &ex) {
+                cerr << "Error: Bad message from the coordinator: " << ex.what() << "\n";
                 break;
             }
         }
+        stop = true;
+    });
 
-        // If doesnt fit on no one, create a new team
-        if (!placed) {
-            Team new_team;
-            new_team.remaining_budget = instance.B - p.salary;
-            new_team.players.push_back(p.id);
-            teams.push_back(move(new_team));
+    Rng rng(seed);
+    vector<Team> current_solution = construct_initial_solution(instance, rng);
+    vector<Team> best_solution = current_solution;
+    connection->send_line("solution" + format_teams_line(best_solution));
+    int iterations_done = 0, last_improvement = 0;
+    bool restart_requested = false;
+
+    while (!stop && !deadline.expired_now() && !connection->closed) {
+        best_solution = ils_search(instance, current_solution, best_solution, rng, params, iterations_done, deadline,
+            [&]() { return stop || inbox; },
+            [&](const vector<Team> &solution) {
+                last_improvement = iterations_done;
+                LOG(LOG_INFO, "(" << chrono::duration_cast<chrono::duration<double>>(chrono::high_resolution_clock::now() - start).count()
+                     << ") New solution found in LS: " << solution.size() << " teams.\n");
+                connection->send_line("solution" + format_teams_line(solution));
+            },
+            [&](const vector<Team> &best, const vector<Team> &current) {
+                current_solution = current;
+                if (restart_interval > 0 && !restart_requested && iterations_done - last_improvement >= restart_interval) {
+                    restart_requested = true;
+                    connection->send_line("restart" + format_teams_line(best));
+                }
+            });
+        if (!inbox) continue;
+
+        // Continue from what the coordinator sent
+        lock_guard<mutex> lock(inbox_mutex);
+        inbox = false;
+        if (!incumbent.empty() && incumbent.size() < best_solution.size()) {
+            best_solution = incumbent;
+            current_solution = incumbent;
+            LOG(LOG_INFO, "Continuing from the incumbent: " << incumbent.size() << " teams.\n");
         }
+        if (!restart.empty()) {
+            current_solution = move(restart);
+            restart.clear();
+            restart_requested = false;
+            last_improvement = iterations_done;
+        }
+        incumbent.clear();
     }
 
-    return teams;
+    shutdown(fd, SHUT_RDWR);
+    reader.join();
+    close(fd);
+    LOG(LOG_INFO, "\nWorker finished after " << iterations_done << " iterations; best solution uses "
+         << best_solution.size() << " teams.\n");
+    return 0;
 }
 
+// ================= C API ================= //
+// Implementation of ils.h (built into libils.so with -DILS_LIBRARY, which leaves out main)
+
+struct ils_instance {
+    ProblemInstance instance;
+    // Made by ils_apply_delta: players of the previous instance and id here of each of them,
+    // added players included (-1 = removed)
+    int previous_players = 0;
+    vector<int> delta_ids;
+};
+
+static thread_local string ils_error;
+
 /**
- * @brief Step in the neighborhood of the localsearch by attempting to dissolve a given team
- *        and redistribute its players.
+ * @brief Converts an assignment (team of each player, 1-based) into a validated solution.
  * 
- * @param teams Current list of teams.
+ * @param assignment Team of each player.
  * @param instance The problem instance with players and constraints.
- * @param team_to_dissolve Index of the team selected to attempt dissolution.
  * 
- * @return tuple<vector<Team>, bool, int> 
- *         - Updated set of teams.
- *         - Boolean flag indicating whether the team was successfully dissolved.
- *         - Number of players moved during the step (score of neighbor).
+ * @return vector<Team> The solution.
+ * @throws runtime_error If the assignment is not a feasible solution.
  */
-tuple<vector<Team>, bool, int> local_search_step(std::vector<Team> teams, const ProblemInstance instance, int team_to_dissolve) {
-    if (teams.size() <= 1) return {teams, false, 0};
-    
-    Team &src_team = teams[team_to_dissolve];
-    int players_moved=0; // How many players of this team could be moved
-    
-    if (src_team.players.empty()) return {teams, false, 0};
-
-    std::vector<int> remaining_players; // Players that we fail to move
-    bool all_moved = true;
-    int total_economy = 0; // Money saved from the source team from removing players
-
-    // Try to move every player
-    for (int pid : src_team.players) {
-        const Player &p = instance.players[pid];
-        bool moved = false;
-
-        for (int i = 0; i < (int)teams.size(); i++) {
-            if (i == team_to_dissolve) continue; // skip own team
-            if (can_add_to_team(teams[i], p)) {
-                teams[i].players.push_back(pid);
-                teams[i].remaining_budget -= p.salary;
-                total_economy+=p.salary;
-                moved = true;
-                players_moved++; //count everytime a player is moved
-                break; // stop once we place the player
-            }
-        }
-
-        if (!moved) {
-            remaining_players.push_back(pid);
-            all_moved = false;
-        }
-    }
-
-    // If we moved everyone, delete the team (improvement)
-    if (all_moved) {
-        teams.erase(teams.begin() + team_to_dissolve);
-        return {teams, true, players_moved};
+vector<Team> assignment_to_teams(const int *assignment, const ProblemInstance &instance) {
+    vector<Team> solution;
+    for (int pid = 0; pid < instance.J; pid++) {
+        int t = assignment[pid];
+        if (t < 1 || t > instance.J) throw runtime_error("Invalid team " + to_string(t) + " for player " + to_string(pid + 1));
+        if ((int)solution.size() < t) solution.resize(t, Team{instance.B, {}});
+        solution[t - 1].players.push_back(pid);
+        solution[t - 1].remaining_budget -= instance.players[pid].salary;
     }
-
-    // Update the source team’s players and budget
-    src_team.players = remaining_players;
-    src_team.remaining_budget+=total_economy;
-    
-    return {teams, false, players_moved}; // no full team dissolved
+    solution.erase(remove_if(solution.begin(), solution.end(), [](const Team &team) { return team.players.empty(); }),
+                   solution.end());
+    string error;
+    if (!validate_solution(solution, instance, error)) throw runtime_error("Infeasible assignment: " + error);
+    return solution;
 }
 
 /**
- * @brief Executes a local search to improve the solution.
+ * @brief Writes the team of each player (1-based) of a solution.
  * 
- * @details The neighborhood behavior is the following:
- *  1. For each team, generate a neighbor by exploding that team.
- *  2. If this neighbor dissolves the team, immediately select it and stop checking further teams.
- *  3. Otherwise, if the neighbor’s score (`neighbor_score`) is better than `last_score`,
- *     immediately select it and stop checking further teams.
- *  4. If no neighbor improves upon `last_score`, choose the neighbor with the highest score
- *     among all teams.
- *  5. If after 20 iterations no best_score is found nor team is dissolved, the search stops.
- * @param initial The starting solution (vector of teams).
- * @param instance The problem instance with players and constraints.
+ * @param solution The solution.
+ * @param assignment Output: team of each player.
  * 
- * @return vector<Team> The best solution found by local search.
+ * @return void
  */
-vector<Team> local_search(vector<Team> initial, const ProblemInstance &instance) {
-    vector<Team> best_solution = initial;
-    vector<Team> current_solution = best_solution; // This will be current node on the neighbors graph
-    vector<Team> target_neighbor; 
-    int iterations_without_improvement=0; //Stop if nothing gets better after X iterations
-    int last_score=0; // This will be the score of the last step on the graph
-                     // It will be used to check if found a best score than the last one
-    int best_score=0; // This will be the highest score since the last dissolution
-    vector<Team> last_node; // This will be used to check for loops
-    while(true) {
-        int target_neighbor_score=-1; 
-        int current_best_score=-1; // The scores of the neighbors (best will be chosen for each step)
-        iterations_without_improvement++;
-        int team_exploded_idx;
-
-        // EACH ITERATION: node of solutions graph
+void teams_to_assignment(const vector<Team> &solution, int *assignment) {
+    for (size_t t = 0; t < solution.size(); t++) {
+        for (int pid : solution[t].players) assignment[pid] = (int)t + 1;
+    }
+}
 
-        // For every available team, considering stepping to its direction
-        // Graph step: choose this team to dissolve
-        bool dissolved = false;
-        for(int team_idx=0; team_idx < current_solution.size(); team_idx++){
-            vector<Team> neighbor;
-            int neighbor_score=0; // Score is how many players of this team could be moved out
+extern "C" {
 
-            // Get neighbor for testing score
-            tie(neighbor, dissolved, neighbor_score) = local_search_step(current_solution, instance, team_idx);
+int ils_api_version(void) {
+    return ILS_API_VERSION;
+}
 
-            if (dissolved) {
-                // If the team was successfully removed (rare), choose this and stop looking for other neighbors
-                target_neighbor=neighbor;
-                best_solution=neighbor; //Only update the best solution output when a team is dissolved (-1 total teams)
-                team_exploded_idx=team_idx;
-                target_neighbor_score=0;
-                iterations_without_improvement=0;
-                best_score=0; // best_score is reset
-                break; //go to next iteration
-            }
+const char *ils_last_error(void) {
+    return ils_error.c_str();
+}
 
-            // First FIT (if neighbor score is better than the last score)
-            if(neighbor_score > last_score){
-                target_neighbor_score=neighbor_score;
-                target_neighbor = neighbor;
-                team_exploded_idx=team_idx;
-                if(neighbor_score>best_score){
-                    best_score=neighbor_score; // keep track if it improves
-                    iterations_without_improvement=0;
-                }
-                break;
-            }
+ils_instance *ils_load_file(const char *path, size_t memory_cap_mb) {
+    try {
+        auto handle = make_unique<ils_instance>();
+        handle->instance = read_instance(path, memory_cap_mb ? memory_cap_mb << 20 : DEFAULT_MEMORY_CAP);
+        return handle.release();
+    } catch (const exception &ex) {
+        ils_error = ex.what();
+        return nullptr;
+    }
+}
 
-            // If no neighbor has a better score than the last node
-            // Use the best among the neighbors
-            if(neighbor_score>current_best_score){
-                current_best_score=neighbor_score;
-                target_neighbor_score=neighbor_score;
-                target_neighbor = neighbor;
-                team_exploded_idx=team_idx;
-                // iterations_without_improvement ISNT reset
+ils_instance *ils_load_arrays(int budget, int players, const int *salaries, int conflicts, const int *conflict_pairs) {
+    try {
+        if (players < 1 || conflicts < 0 || !salaries || (conflicts > 0 && !conflict_pairs)) {
+            throw runtime_error("Invalid instance arrays");
+        }
+        auto handle = make_unique<ils_instance>();
+        ProblemInstance &instance = handle->instance;
+        instance.B = budget;
+        instance.J = players;
+        instance.I = conflicts;
+        instance.players.resize(players);
+        for (int i = 0; i < players; i++) {
+            instance.players[i].id = i;
+            instance.players[i].salary = salaries[i];
+        }
+        vector<pair<int,int>> edges(conflicts);
+        for (int k = 0; k < conflicts; k++) {
+            int u = conflict_pairs[2 * k], v = conflict_pairs[2 * k + 1];
+            if (u < 1 || v < 1 || u > players || v > players) {
+                throw runtime_error("Conflict " + to_string(u) + " " + to_string(v) + " refers to an unknown player");
             }
+            edges[k] = {u - 1, v - 1};
         }
-        current_solution = target_neighbor; // WALK on the solutions graph
-        last_score=target_neighbor_score;
+        build_adjacency(instance, edges);
+        return handle.release();
+    } catch (const exception &ex) {
+        ils_error = ex.what();
+        return nullptr;
+    }
+}
 
-        // Logs each step
-        // if(dissolved){
-        //     cout << "Succesffuly dissolved team number " << team_exploded_idx+1 << " moving " << target_neighbor_score << " (all) players. \n";
-        //     cout << "New solution has " << current_solution.size() << " teams. \n";
-        // }else{
-        //     cout << "Exploded team number " << team_exploded_idx+1 << " moving " << target_neighbor_score << " players. \n";
-        // }
-
-        if(iterations_without_improvement>20) {
-            // After trying a lot and not dissolving any team, stop local search
-            break;
-        }
+void ils_free_instance(ils_instance *instance) {
+    delete instance;
+}
 
-    }
+int ils_player_count(const ils_instance *instance) {
+    return instance ? instance->instance.J : 0;
+}
 
-    return best_solution;
-    
+void ils_default_params(ils_params *params) {
+    IlsParams defaults;
+    params->time_limit = 5;
+    params->max_iterations = 0;
+    params->seed = 1;
+    params->perturbation_ratio = defaults.perturbation_ratio;
+    params->pool_interval = defaults.pool_interval;
+    params->alns = defaults.alns;
+    params->acceptance = defaults.acceptance;
+    params->stagnation_limit = defaults.stagnation_limit;
+    params->matching = defaults.matching;
+    params->exact_interval = defaults.exact_interval;
+    params->exact_nodes = defaults.exact_nodes;
+    params->constructor = CONSTRUCT_FIRST_FIT;
 }
 
-/**
- * @brief Applies a perturbation to the current solution by moving a random percentage 
- *        of players to new teams, creating new teams if moving fails.
- * 
- * @param solution Current solution.
- * @param rng Random number generator for selecting players to move.
- * @param instance The original problem instance with players and constraints.
- * @param perturbation_ratio The percentage of players to perturb (0.0–1.0).
- * 
- * @return vector<Team> The perturbed solution after reassignments.
- */
-vector<Team> perturbation(vector<Team> solution, mt19937 &rng, ProblemInstance instance, double perturbation_ratio) {
-    // Flatten all players with (team_id, player_id)
-    vector<pair<int,int>> all_players;
-    for (int tid = 0; tid < (int)solution.size(); tid++) {
-        for (int pid : solution[tid].players) {
-            all_players.push_back({tid, pid});
-        }
+int ils_construct(const ils_instance *instance, uint64_t seed, int *assignment) {
+    try {
+        if (!instance || !assignment) throw runtime_error("Null argument");
+        Rng rng(seed);
+        vector<Team> solution = construct_initial_solution(instance->instance, rng, CONSTRUCT_FFD);
+        teams_to_assignment(solution, assignment);
+        return (int)solution.size();
+    } catch (const exception &ex) {
+        ils_error = ex.what();
+        return -1;
     }
+}
+
+int ils_solve(const ils_instance *instance, const ils_params *params, const int *initial_assignment, int *assignment,
+              ils_stats *stats) {
+    try {
+        if (!instance || !params || !assignment) throw runtime_error("Null argument");
+        if (params->acceptance < ACCEPT_ALWAYS || params->acceptance > ACCEPT_LATE_ACCEPTANCE) {
+            throw runtime_error("Unknown acceptance criterion " + to_string(params->acceptance));
+        }
+        if (params->constructor < 0 || params->constructor >= CONSTRUCTOR_COUNT) {
+            throw runtime_error("Unknown constructor " + to_string(params->constructor));
+        }
+        if (params->stagnation_limit < 1) throw runtime_error("stagnation_limit must be positive");
+        auto start = chrono::high_resolution_clock::now();
+        auto elapsed = [&]() {
+            return chrono::duration_cast<chrono::duration<double>>(chrono::high_resolution_clock::now() - start).count();
+        };
+        const ProblemInstance &problem = instance->instance;
 
-    if (all_players.empty()) return solution;
+        Rng rng(params->seed);
+        Constructor constructor = (Constructor)params->constructor;
+        vector<Team> initial = initial_assignment ? assignment_to_teams(initial_assignment, problem)
+                                                  : construct_initial_solution(problem, rng, constructor);
 
-    // Determine how many players to move, ranging from [1, all_players.size()]
-    size_t proposed = static_cast<size_t>(all_players.size() * perturbation_ratio);
-    size_t num_to_move = std::max<size_t>(1, std::min(all_players.size(), proposed));
-    shuffle(all_players.begin(), all_players.end(), rng);
-    vector<pair<int,int>> chosen(all_players.begin(), all_players.begin() + static_cast<long>(num_to_move));
+        IlsParams ils_params;
+        ils_params.perturbation_ratio = params->perturbation_ratio;
+        ils_params.pool_interval = params->pool_interval;
+        ils_params.alns = params->alns != 0;
+        ils_params.acceptance = (AcceptanceCriterion)params->acceptance;
+        ils_params.stagnation_limit = params->stagnation_limit;
+        ils_params.matching = params->matching != 0;
+        ils_params.exact_interval = params->exact_interval;
+        ils_params.exact_nodes = params->exact_nodes;
+        int iterations = 0, improvements = 0;
+        Deadline deadline(start, params->time_limit);
+        vector<Team> best = ils_search(problem, initial, initial, rng, ils_params, iterations, deadline,
+            [&]() { return params->max_iterations > 0 && iterations >= params->max_iterations; },
+            [&](const vector<Team> &) { improvements++; },
+            [](const vector<Team> &, const vector<Team> &) {});
 
-    // Remove chosen players from their teams
-    for (const auto &tp : chosen) {
-        int tid = tp.first;
-        int pid = tp.second;
-        auto &team = solution[tid];
-        team.players.erase(remove(team.players.begin(), team.players.end(), pid), team.players.end());
+        teams_to_assignment(best, assignment);
+        if (stats) {
+            stats->initial_teams = (int)initial.size();
+            stats->teams = (int)best.size();
+            stats->improvements = improvements;
+            stats->iterations = iterations;
+            stats->seconds = elapsed();
+        }
+        return (int)best.size();
+    } catch (const exception &ex) {
+        ils_error = ex.what();
+        return -1;
     }
+}
 
-    // Recompute team budgets after removals
-    for (auto &team : solution) {
-        team.remaining_budget = instance.B;
-        for (int pid : team.players) {
-            team.remaining_budget -= instance.players[pid].salary;
+ils_instance *ils_apply_delta(const ils_instance *instance, const char *delta_path) {
+    try {
+        if (!instance || !delta_path) throw runtime_error("Null argument");
+        auto handle = make_unique<ils_instance>();
+        InstanceDelta delta = load_delta(delta_path, instance->instance.J);
+        handle->instance = apply_delta(instance->instance, delta, handle->delta_ids);
+        handle->previous_players = instance->instance.J;
+        return handle.release();
+    } catch (const exception &ex) {
+        ils_error = ex.what();
+        return nullptr;
+    }
+}
+
+int ils_repair(const ils_instance *updated, const int *previous_assignment, int *assignment, int *ejected) {
+    try {
+        if (!updated || !previous_assignment || !assignment) throw runtime_error("Null argument");
+        if (updated->delta_ids.empty()) throw runtime_error("The instance was not made by ils_apply_delta");
+        const ProblemInstance &problem = updated->instance;
+        vector<Team> previous;
+        for (int pid = 0; pid < updated->previous_players; pid++) {
+            int t = previous_assignment[pid];
+            if (t < 1 || t > updated->previous_players) {
+                throw runtime_error("Invalid team " + to_string(t) + " for player " + to_string(pid + 1));
+            }
+            if ((int)previous.size() < t) previous.resize(t);
+            previous[t - 1].players.push_back(pid);
         }
+        int reinserted = 0;
+        vector<Team> repaired = repair_solution(previous, problem, updated->delta_ids, reinserted);
+        teams_to_assignment(repaired, assignment);
+        if (ejected) *ejected = reinserted;
+        return (int)repaired.size();
+    } catch (const exception &ex) {
+        ils_error = ex.what();
+        return -1;
     }
+}
 
-    // Try to reassign each chosen player
-    for (const auto &tp : chosen) {
-        int old_tid = tp.first;
-        (void)old_tid; // not used, but kept for clarity
-        int pid = tp.second;
-        const Player &p = instance.players[pid];
-        bool placed = false;
+} // extern "C"
 
-        for (auto &team : solution) {
-            if (can_add_to_team(team, p)) {
-                team.players.push_back(pid);
-                team.remaining_budget -= p.salary;
-                placed = true;
-                break;
+
+#ifndef ILS_LIBRARY
+int main(int argc, char* argv[]) {
+    auto start = chrono::high_resolution_clock::now();
+
+    // Server mode: ils_time --server [--socket PATH] [--workers N] [--memory_cap MB]
+    if (argc >= 2 && string(argv[1]) == "--server") {
+        string socket_path;
+        size_t workers = max(1u, thread::hardware_concurrency());
+        size_t memory_cap = DEFAULT_MEMORY_CAP;
+        for (int a = 2; a + 1 < argc; a += 2) {
+            string flag = argv[a];
+            if (flag == "--socket") {
+                socket_path = argv[a + 1];
+            } else if (flag == "--workers") {
+                workers = max(1, stoi(argv[a + 1]));
+            } else if (flag == "--memory_cap") {
+                memory_cap = stoull(argv[a + 1]) << 20;
+            } else {
+                cerr << "Unknown option: " << flag << "\n";
+                return 1;
             }
         }
+        return run_server(socket_path, workers, memory_cap);
+    }
 
-        // If no team can fit, create a new one
-        if (!placed) {
-            Team new_team;
-            new_team.remaining_budget = instance.B - p.salary;
-            new_team.players.push_back(pid);
-            solution.push_back(move(new_team));
+    // Cooperative search: ils_time --coordinate <instance> <time> [--port P] [--bind ADDR] [--target T] [--seed S] [--save_solution FILE] [--memory_cap MB]
+    if (argc >= 2 && string(argv[1]) == "--coordinate") {
+        if (argc < 4) {
+            cerr << "Usage: " << argv[0] << " --coordinate <instance_file> <time> [--port P] [--bind ADDR] [--target T]"
+                 << " [--seed S] [--save_solution FILE] [--memory_cap MB]\n";
+            return 1;
+        }
+        int port = DEFAULT_COORDINATOR_PORT, target = 0;
+        string bind_address = DEFAULT_COORDINATOR_BIND, save_file;
+        uint64_t seed = 1;
+        size_t memory_cap = DEFAULT_MEMORY_CAP;
+        for (int a = 4; a + 1 < argc; a += 2) {
+            string flag = argv[a];
+            if (flag == "--port") {
+                port = stoi(argv[a + 1]);
+            } else if (flag == "--bind") {
+                bind_address = argv[a + 1];
+            } else if (flag == "--seed") {
+                seed = stoull(argv[a + 1]);
+            } else if (flag == "--target") {
+                target = stoi(argv[a + 1]);
+            } else if (flag == "--save_solution") {
+                save_file = argv[a + 1];
+            } else if (flag == "--memory_cap") {
+                memory_cap = stoull(argv[a + 1]) << 20;
+            } else {
+                cerr << "Unknown option: " << flag << "\n";
+                return 1;
+            }
+        }
+        try {
+            return run_coordinator(argv[2], stod(argv[3]), port, bind_address, target, save_file, seed, memory_cap);
+        } catch (const exception &ex) {
+            cerr << "Error: " << ex.what() << "\n";
+            return 1;
         }
     }
 
-    return solution;
-}
+    // Worker of a cooperative search: ils_time --work <host:port> <instance> <seed> [options]
+    if (argc >= 2 && string(argv[1]) == "--work") {
+        if (argc < 5) {
+            cerr << "Usage: " << argv[0] << " --work <host:port> <instance_file> <seed> [--perturbation_ratio N]"
+                 << " [--stagnation N] [--restart_interval N] [--memory_cap MB]\n";
+            return 1;
+        }
+        IlsParams params;
+        int restart_interval = DEFAULT_RESTART_INTERVAL;
+        size_t memory_cap = DEFAULT_MEMORY_CAP;
+        for (int a = 5; a + 1 < argc; a += 2) {
+            string flag = argv[a];
+            if (flag == "--perturbation_ratio") {
+                params.perturbation_ratio = stod(argv[a + 1]);
+            } else if (flag == "--stagnation") {
+                params.stagnation_limit = max(1, stoi(argv[a + 1]));
+            } else if (flag == "--restart_interval") {
+                restart_interval = stoi(argv[a + 1]);
+            } else if (flag == "--memory_cap") {
+                memory_cap = stoull(argv[a + 1]) << 20;
+            } else {
+                cerr << "Unknown option: " << flag << "\n";
+                return 1;
+            }
+        }
+        try {
+            return run_worker(argv[2], argv[3], stoull(argv[4]), params, restart_interval, memory_cap);
+        } catch (const exception &ex) {
+            cerr << "Error: " << ex.what() << "\n";
+            return 1;
+        }
+    }
 
+    // Re-optimization after a delta: ils_time --update <instance> <solution> <delta> <time> <seed> [options]
+    if (argc >= 2 && string(argv[1]) == "--update") {
+        if (argc < 7) {
+            cerr << "Usage: " << argv[0] << " --update <instance_file> <solution_file> <delta_file> <time> <seed>"
+                 << " [--perturbation_ratio N] [--max_iterations N] [--save_instance FILE] [--save_solution FILE]"
+                 << " [--verbosity 0-3] [--memory_cap MB]\n";
+            return 1;
+        }
+        IlsParams params;
+        int max_iterations = 0;
+        string save_instance, save_solution;
+        size_t memory_cap = DEFAULT_MEMORY_CAP;
+        for (int a = 7; a + 1 < argc; a += 2) {
+            string flag = argv[a];
+            if (flag == "--perturbation_ratio") {
+                params.perturbation_ratio = stod(argv[a + 1]);
+            } else if (flag == "--max_iterations") {
+                max_iterations = stoi(argv[a + 1]);
+            } else if (flag == "--save_instance") {
+                save_instance = argv[a + 1];
+            } else if (flag == "--save_solution") {
+                save_solution = argv[a + 1];
+            } else if (flag == "--verbosity") {
+                logger.level = stoi(argv[a + 1]);
+            } else if (flag == "--memory_cap") {
+                memory_cap = stoull(argv[a + 1]) << 20;
+            } else {
+                cerr << "Unknown option: " << flag << "\n";
+                return 1;
+            }
+        }
+        try {
+            return run_update(argv[2], argv[3], argv[4], stod(argv[5]), stoull(argv[6]), params, max_iterations,
+                              save_instance, save_solution, memory_cap);
+        } catch (const exception &ex) {
+            cerr << "Error: " << ex.what() << "\n";
+            return 1;
+        }
+    }
 
-int main(int argc, char* argv[]) {
-    auto start = chrono::high_resolution_clock::now();
+    // Tuning mode: ils_time --tune <time> <instance>... [--budget N] [--workers N] [--seed S] [--output FILE]
+    if (argc >= 2 && string(argv[1]) == "--tune") {
+        if (argc < 4) {
+            cerr << "Usage: " << argv[0] << " --tune <time> <instance_file>... [--budget N] [--workers N]"
+                 << " [--seed S] [--output FILE]\n";
+            return 1;
+        }
+        double run_time = stod(argv[2]);
+        vector<string> files;
+        int a = 3;
+        for (; a < argc && string(argv[a]).rfind("--", 0) != 0; a++) files.push_back(argv[a]);
+        int budget = 150;
+        size_t workers = max(1u, thread::hardware_concurrency());
+        uint64_t tune_seed = 1;
+        string output = "ils_config.csv";
+        for (; a + 1 < argc; a += 2) {
+            string flag = argv[a];
+            if (flag == "--budget") {
+                budget = stoi(argv[a + 1]);
+            } else if (flag == "--workers") {
+                workers = max(1, stoi(argv[a + 1]));
+            } else if (flag == "--seed") {
+                tune_seed = stoull(argv[a + 1]);
+            } else if (flag == "--output") {
+                output = argv[a + 1];
+            } else {
+                cerr << "Unknown option: " << flag << "\n";
+                return 1;
+            }
+        }
+        try {
+            return run_tuner(files, run_time, budget, workers, tune_seed, output);
+        } catch (const exception &ex) {
+            cerr << "Error: " << ex.what() << "\n";
+            return 1;
+        }
+    }
 
     // Checks for right amount of arguments
     if (argc < 4) {
         cerr << "Usage: " << argv[0]
-        << " <instance_file> <time> <seed> [--perturbation_ratio N]\n";
+        << " <instance_file> <time> <seed> [--perturbation_ratio N] [--pool_interval N]"
+        << " [--mode ils|alns|memetic] [--population N] [--reduce]"
+        << " [--initial_solution FILE] [--save_solution FILE]"
+        << " [--checkpoint FILE] [--checkpoint_interval S] [--resume FILE] [--benchmark]"
+        << " [--verbosity 0-3] [--acceptance always|better_equal|sa|lahc]"
+        << " [--sa_temperature T] [--sa_cooling C] [--lahc_length L]"
+        << " [--max_iterations N] [--results_file FILE] [--memory_cap MB]"
+        << " [--stagnation N] [--constructor first_fit|ffd|degree] [--config FILE]"
+        << " [--exact_interval N] [--exact_nodes N] [--matching] [--renumber none|rcm|degree]\n"
+        << "       " << argv[0] << " --server [--socket PATH] [--workers N] [--memory_cap MB]\n"
+        << "       " << argv[0] << " --tune <time> <instance_file>... [--budget N] [--workers N] [--seed S] [--output FILE]\n"
+        << "       " << argv[0] << " --coordinate <instance_file> <time> [--port P] [--bind ADDR] [--target T] [--seed S] [--save_solution FILE]\n"
+        << "       " << argv[0] << " --work <host:port> <instance_file> <seed> [--perturbation_ratio N] [--restart_interval N]\n";
         return 1;
     }
 
@@ -426,12 +5246,110 @@ int main(int argc, char* argv[]) {
     int time = stod(argv[2]);
     int seed = stoi(argv[3]);
     double perturbation_ratio = 0.15;
+    int pool_interval = 0; // ILS iterations between pool recombinations (0 = disabled)
+    string mode = "ils"; // "ils", "alns" or "memetic"
+    int population_size = 10; // individuals of the memetic mode
+    IlsParams ils_params; // acceptance settings (the other fields are filled below)
+    bool reduce = false; // run the instance reduction before the search
+    PlayerOrder player_order = ORDER_INPUT; // renumbering of the players of the search instance
+    string initial_solution_file; // warm start from this solution
+    string save_solution_file; // write the best solution here at the end
+    string checkpoint_file; // periodically save the state of the run here
+    double checkpoint_interval = 30; // seconds between checkpoints
+    string resume_file; // continue the run saved in this checkpoint
+    bool benchmark = false; // time each phase once instead of running the search
+    int max_iterations = 0; // ILS/ALNS: also stop after this many iterations (0 = time limit only)
+    string results_file = "ils_results.csv"; // the result row is appended here
+    size_t memory_cap = DEFAULT_MEMORY_CAP; // bytes the conflict graph may use
+    Constructor constructor = CONSTRUCT_FIRST_FIT; // player order of the initial solution
+    string config_file; // tuned configurations (--tune), applied to the parameters not given
+    set<string> given; // options present on the command line
 
-    // Check optional argument
-    if (argc == 6) {
-        string flag = argv[4];
+    // Check optional arguments
+    for (int a = 4; a < argc; a++) {
+        string flag = argv[a];
+        given.insert(flag);
+        if (flag == "--reduce") {
+            reduce = true;
+            continue;
+        }
+        if (flag == "--benchmark") {
+            benchmark = true;
+            continue;
+        }
+        if (flag == "--matching") {
+            ils_params.matching = true;
+            continue;
+        }
+        if (a + 1 >= argc) {
+            cerr << "Missing value for option: " << flag << "\n";
+            return 1;
+        }
         if (flag == "--perturbation_ratio") {
-            perturbation_ratio = stof(argv[5]);
+            perturbation_ratio = stof(argv[++a]);
+        } else if (flag == "--pool_interval") {
+            pool_interval = stoi(argv[++a]);
+        } else if (flag == "--mode") {
+            mode = argv[++a];
+            if (mode != "ils" && mode != "alns" && mode != "memetic") {
+                cerr << "Unknown mode: " << mode << "\n";
+                return 1;
+            }
+        } else if (flag == "--population") {
+            population_size = max(2, stoi(argv[++a]));
+        } else if (flag == "--initial_solution") {
+            initial_solution_file = argv[++a];
+        } else if (flag == "--save_solution") {
+            save_solution_file = argv[++a];
+        } else if (flag == "--checkpoint") {
+            checkpoint_file = argv[++a];
+        } else if (flag == "--checkpoint_interval") {
+            checkpoint_interval = stod(argv[++a]);
+        } else if (flag == "--resume") {
+            resume_file = argv[++a];
+        } else if (flag == "--acceptance") {
+            try {
+                ils_params.acceptance = parse_acceptance(argv[++a]);
+            } catch (const exception &ex) {
+                cerr << ex.what() << "\n";
+                return 1;
+            }
+        } else if (flag == "--sa_temperature") {
+            ils_params.sa_temperature = stod(argv[++a]);
+        } else if (flag == "--sa_cooling") {
+            ils_params.sa_cooling = stod(argv[++a]);
+        } else if (flag == "--lahc_length") {
+            ils_params.lahc_length = stoi(argv[++a]);
+        } else if (flag == "--verbosity") {
+            logger.level = stoi(argv[++a]);
+        } else if (flag == "--max_iterations") {
+            max_iterations = stoi(argv[++a]);
+        } else if (flag == "--results_file") {
+            results_file = argv[++a];
+        } else if (flag == "--memory_cap") {
+            memory_cap = stoull(argv[++a]) << 20;
+        } else if (flag == "--stagnation") {
+            ils_params.stagnation_limit = max(1, stoi(argv[++a]));
+        } else if (flag == "--constructor") {
+            try {
+                constructor = parse_constructor(argv[++a]);
+            } catch (const exception &ex) {
+                cerr << ex.what() << "\n";
+                return 1;
+            }
+        } else if (flag == "--config") {
+            config_file = argv[++a];
+        } else if (flag == "--exact_interval") {
+            ils_params.exact_interval = stoi(argv[++a]);
+        } else if (flag == "--exact_nodes") {
+            ils_params.exact_nodes = stoll(argv[++a]);
+        } else if (flag == "--renumber") {
+            try {
+                player_order = parse_player_order(argv[++a]);
+            } catch (const exception &ex) {
+                cerr << ex.what() << "\n";
+                return 1;
+            }
         } else {
             cerr << "Unknown option: " << flag << "\n";
             return 1;
@@ -441,56 +5359,180 @@ int main(int argc, char* argv[]) {
 
     try {
         // Read problem instance
-        ProblemInstance instance = read_instance(instance_file);
+        ProblemInstance instance = read_instance(instance_file, memory_cap);
+        double read_seconds = chrono::duration_cast<chrono::duration<double>>(chrono::high_resolution_clock::now() - start).count();
+
+        LOG(LOG_INFO, "Read instance with " << instance.J << " players, "
+        << instance.I << " conflicts, budget " << instance.B << "\n"
+        << "Time = " << time << "\n"
+        << "Seed = " << seed << "\n");
+        LOG(LOG_DEBUG, "Conflict graph stored as " << adjacency_name(instance.adjacency->kind) << " ("
+             << instance.adjacency->memory_bytes() / 1024 << " KB).\n");
+
+        // Parameters of the nearest tuned instance (options on the command line take precedence)
+        if (!config_file.empty()) {
+            ConfigModel model = load_config_model(config_file);
+            size_t row = nearest_config(model, instance_features(instance));
+            const TunedConfig &tuned = model.configs[row];
+            if (!given.count("--perturbation_ratio")) perturbation_ratio = tuned.perturbation_ratio;
+            if (!given.count("--stagnation")) ils_params.stagnation_limit = tuned.stagnation_limit;
+            if (!given.count("--constructor")) constructor = tuned.constructor;
+            if (!given.count("--acceptance")) ils_params.acceptance = tuned.acceptance;
+            LOG(LOG_INFO, "Configuration of " << model.instances[row] << " from " << config_file << ": "
+                 << format_config({perturbation_ratio, ils_params.stagnation_limit, constructor, ils_params.acceptance}) << "\n");
+        }
+
+        // Warm start and resume (files use the original player ids)
+        vector<Team> warm_start;
+        Checkpoint resumed;
+        if (!resume_file.empty()) {
+            resumed = load_checkpoint(resume_file, instance);
+            LOG(LOG_INFO, "Resuming from " << resume_file << " (best " << resumed.best.size() << " teams, "
+                 << resumed.iterations << " iterations done).\n");
+        } else if (!initial_solution_file.empty()) {
+            warm_start = load_solution(initial_solution_file, instance);
+            LOG(LOG_INFO, "Loaded initial solution with " << warm_start.size() << " teams.\n");
+        }
+
+        // The search works on the reduced instance, solutions are mapped back for output
+        Reduction reduction;
+        if (reduce) {
+            reduction = reduce_instance(instance);
+            LOG(LOG_INFO, "Reduction removed " << reduction.duplicate_edges << " duplicate and "
+                 << reduction.dead_edges << " non-binding conflicts, fixed "
+                 << reduction.fixed_teams.size() << " players alone; "
+                 << reduction.reduced.J << " players and " << reduction.reduced.I << " conflicts left.\n"
+                 << "Lower bound: " << reduction.lower_bound << " teams.\n");
+            instance = move(reduction.reduced);
+        }
+        size_t fixed_teams = reduction.fixed_teams.size();
+
+        // Players are renumbered for memory locality, solutions are renamed back for output
+        Renumbering renumbering;
+        bool renumber = player_order != ORDER_INPUT;
+        if (renumber) {
+            renumbering = renumber_instance(instance, player_order);
+            instance = move(renumbering.renumbered);
+            LOG(LOG_INFO, "Players renumbered by " << player_order_name(player_order) << " order.\n");
+        }
+
+        auto to_search = [&](const vector<Team> &solution) {
+            vector<Team> restricted = reduce ? restrict_solution(solution, reduction) : solution;
+            return renumber ? rename_players(restricted, renumbering.new_id) : restricted;
+        };
+        auto to_output = [&](const vector<Team> &solution) {
+            vector<Team> renamed = renumber ? rename_players(solution, renumbering.original_id) : solution;
+            return reduce ? expand_solution(renamed, reduction) : renamed;
+        };
 
-        cout << "Read instance with " << instance.J << " players, "
-        << instance.I << " conflicts, budget " << instance.B << "\n";
-        cout << "Time = " << time << "\n";
-        cout << "Seed = " << seed << "\n";
+        Rng rng(seed);
+        if (benchmark) {
+            run_benchmark(instance_file, instance, read_seconds, rng, perturbation_ratio);
+            return 0;
+        }
 
-        mt19937 rng(seed);
         // Build initial solution
-        auto initial_solution = construct_initial_solution(instance, rng);
-        cout << "Initial solution has " << initial_solution.size() << " teams.\n";
+        vector<Team> initial_solution;
+        if (!resume_file.empty()) {
+            rng = resumed.rng;
+            initial_solution = to_search(resumed.current);
+        } else if (!initial_solution_file.empty()) {
+            initial_solution = to_search(warm_start);
+        } else {
+            initial_solution = construct_initial_solution(instance, rng, constructor);
+        }
+        LOG(LOG_INFO, "Initial solution has " << initial_solution.size() + fixed_teams << " teams.\n");
 
         vector<Team> best_solution = initial_solution;
         vector<Team> current_solution = best_solution;
 
         int iterations_done = 0; 
         int intermediate_solutions_number = 0;
-        
-        // Compute local search with perturbation many times
-        while(true){
-            auto now_check = chrono::high_resolution_clock::now();
-            auto elapsed_seconds = chrono::duration_cast<chrono::duration<double>>(now_check - start).count();
 
-            if (elapsed_seconds >= time) {
-                cout << "\nTime limit of " << time << "s reached.\n";
-                break;
-            }
-            
-           current_solution = local_search(current_solution, instance);
+        if (!resume_file.empty()) {
+            best_solution = to_search(resumed.best);
+            iterations_done = resumed.iterations;
+            intermediate_solutions_number = resumed.intermediate_solutions;
+        }
 
-            if (current_solution.size() < best_solution.size()){
-                // Get elapsed time for logging
-                auto now = chrono::high_resolution_clock::now();
-                auto elapsed_ms = chrono::duration_cast<chrono::milliseconds>(now - start).count();
-                best_solution = current_solution;
-                intermediate_solutions_number++;
-                cout << "(" << elapsed_ms/1000.0 << ") New solution found in LS: " << best_solution.size() << " teams.\n";    
-                print_solution(best_solution);
-            }
-            
-            current_solution = perturbation(current_solution, rng, instance, perturbation_ratio);
-            
-            iterations_done++;
+        // Saves the state of the run so that it can be resumed
+        auto last_checkpoint = chrono::high_resolution_clock::now();
+        auto write_checkpoint = [&]() {
+            if (checkpoint_file.empty()) return;
+            Checkpoint cp;
+            cp.iterations = iterations_done;
+            cp.intermediate_solutions = intermediate_solutions_number;
+            cp.rng = rng;
+            cp.best = to_output(best_solution);
+            cp.current = to_output(current_solution);
+            save_checkpoint(checkpoint_file, cp);
+            last_checkpoint = chrono::high_resolution_clock::now();
+        };
+
+        // Logs a new best solution
+        auto report_new_best = [&](const vector<Team> &solution, const string &where) {
+            auto now = chrono::high_resolution_clock::now();
+            auto elapsed_ms = chrono::duration_cast<chrono::milliseconds>(now - start).count();
+            intermediate_solutions_number++;
+            LOG(LOG_INFO, "(" << elapsed_ms/1000.0 << ") New solution found in " << where << ": " << solution.size() + fixed_teams << " teams.\n");
+            LOG(LOG_DEBUG, format_solution(to_output(solution)));
+        };
+
+        auto search_start = chrono::high_resolution_clock::now();
+        if (mode == "memetic") {
+            best_solution = memetic_search(instance, initial_solution, rng, population_size, ils_params, constructor,
+                                           start, time, iterations_done,
+                                           [&](const vector<Team> &solution) {
+                if (solution.size() < best_solution.size()) {
+                    best_solution = solution;
+                    current_solution = solution;
+                    report_new_best(best_solution, "memetic search");
+                    write_checkpoint();
+                }
+            });
+            LOG(LOG_INFO, "\nTime limit of " << time << "s reached.\n");
+        }
+        
+        if (mode == "ils" || mode == "alns") {
+            IlsParams params = ils_params;
+            params.perturbation_ratio = perturbation_ratio;
+            params.pool_interval = pool_interval;
+            params.alns = mode == "alns";
+            Deadline deadline(start, time);
+            best_solution = ils_search(instance, current_solution, best_solution, rng, params, iterations_done, deadline,
+                [&]() {
+                    if (max_iterations > 0 && iterations_done >= max_iterations) {
+                        LOG(LOG_INFO, "\nIteration limit of " << max_iterations << " reached.\n");
+                        return true;
+                    }
+                    return false;
+                },
+                [&](const vector<Team> &solution) { report_new_best(solution, "LS"); },
+                [&](const vector<Team> &best, const vector<Team> &current) {
+                    best_solution = best;
+                    current_solution = current;
+                    if (!checkpoint_file.empty() &&
+                        chrono::duration_cast<chrono::duration<double>>(chrono::high_resolution_clock::now() - last_checkpoint).count() >= checkpoint_interval) {
+                        write_checkpoint();
+                    }
+                });
+            if (deadline.reached) LOG(LOG_INFO, "\nTime limit of " << time << "s reached.\n");
         }
+        double search_seconds = chrono::duration_cast<chrono::duration<double>>(chrono::high_resolution_clock::now() - search_start).count();
+        write_checkpoint();
+
+        LOG(LOG_INFO, "\n" << (mode == "ils" ? "ILS" : mode == "alns" ? "ALNS" : "Memetic search") << " finished after " << iterations_done
+             << " iterations in " << search_seconds << " s.\n");
+        best_solution = to_output(best_solution);
+        LOG(LOG_INFO, format_solution(best_solution) << "Final solution uses " << best_solution.size() << " teams.\n");
 
-        cout << "\nILS finished after " << iterations_done << " iterations.\n";
-        cout << "Final solution uses " << best_solution.size() << " teams.\n";
+        if (!save_solution_file.empty()) {
+            write_file_atomically(save_solution_file, [&](ostream &out) { write_solution(out, best_solution); });
+            LOG(LOG_INFO, "Best solution saved to " << save_solution_file << "\n");
+        }
 
         // Save the results to a csv file
-        const string csv_filename = "ils_results.csv";
+        const string &csv_filename = results_file;
         ofstream outfile;
         outfile.open(csv_filename, ios_base::app); 
 
@@ -500,7 +5542,7 @@ int main(int argc, char* argv[]) {
         }
 
         outfile << instance_file << ","
-                << initial_solution.size() << ","
+                << initial_solution.size() + fixed_teams << ","
                 << intermediate_solutions_number << ","
                 << best_solution.size() << ","
                 << iterations_done << ","
@@ -516,4 +5558,5 @@ int main(int argc, char* argv[]) {
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif // ILS_LIBRARY
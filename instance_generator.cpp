@@ -0,0 +1,218 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+#include <cstdint>
+#include <cmath>
+
+using namespace std;
+
+// ================= Generator Parameters ================= //
+struct GeneratorParams {
+    int J; // number of players
+    int B = 1000; // budget per team
+    double degree = 4; // average number of conflicts per player
+    double density = -1; // if >= 0, overrides degree: probability of a conflict between two players
+    string degree_distribution = "uniform"; // "uniform" or "powerlaw"
+    double powerlaw_exponent = 2.5; // exponent of the degree distribution for "powerlaw"
+    string salary_distribution = "uniform"; // "uniform" or "normal"
+    int salary_min = 1;
+    int salary_max = 400;
+};
+
+/**
+ * @brief Draws the salaries of all players.
+ *
+ * @details "uniform" draws from [salary_min, salary_max]; "normal" draws from a normal
+ *          distribution centered in the middle of that range (sd = range / 6), clipped to it.
+ *
+ * @param params The generator parameters.
+ * @param rng Random number generator.
+ *
+ * @return vector<int> The salary of each player.
+ */
+vector<int> generate_salaries(const GeneratorParams &params, mt19937_64 &rng) {
+    vector<int> salaries(params.J);
+    if (params.salary_distribution == "normal") {
+        double mean = (params.salary_min + params.salary_max) / 2.0;
+        double sd = max(1.0, (params.salary_max - params.salary_min) / 6.0);
+        normal_distribution<double> dist(mean, sd);
+        for (int &s : salaries) {
+            s = (int)llround(dist(rng));
+            s = min(params.salary_max, max(params.salary_min, s));
+        }
+    } else {
+        uniform_int_distribution<int> dist(params.salary_min, params.salary_max);
+        for (int &s : salaries) s = dist(rng);
+    }
+    return salaries;
+}
+
+/**
+ * @brief Draws the conflict pairs (0-based, no self conflicts, no repeated pairs).
+ *
+ * @details The number of conflicts is J * degree / 2 (or density * J * (J - 1) / 2).
+ *          "uniform" picks both players uniformly; "powerlaw" picks each endpoint with
+ *          probability proportional to a Chung-Lu weight (rank^(-1 / (exponent - 1))),
+ *          so a few players get many conflicts. Player ranks are shuffled so that
+ *          high-degree players are spread over the ids.
+ *
+ * @param params The generator parameters.
+ * @param rng Random number generator.
+ *
+ * @return vector<pair<int,int>> The conflict pairs.
+ */
+vector<pair<int,int>> generate_conflicts(const GeneratorParams &params, mt19937_64 &rng) {
+    long long J = params.J;
+    long long max_edges = J * (J - 1) / 2;
+    long long target = params.density >= 0 ? llround(params.density * max_edges)
+                                           : llround(params.degree * J / 2.0);
+    target = min(target, max_edges);
+
+    // Endpoint sampler
+    uniform_int_distribution<int> uniform(0, params.J - 1);
+    discrete_distribution<int> weighted;
+    vector<int> rank_to_player;
+    bool powerlaw = params.degree_distribution == "powerlaw";
+    if (powerlaw) {
+        vector<double> weights(params.J);
+        for (int r = 0; r < params.J; r++) weights[r] = pow(r + 1.0, -1.0 / (params.powerlaw_exponent - 1.0));
+        weighted = discrete_distribution<int>(weights.begin(), weights.end());
+        rank_to_player.resize(params.J);
+        iota(rank_to_player.begin(), rank_to_player.end(), 0);
+        shuffle(rank_to_player.begin(), rank_to_player.end(), rng);
+    }
+    auto endpoint = [&]() { return powerlaw ? rank_to_player[weighted(rng)] : uniform(rng); };
+
+    vector<pair<int,int>> conflicts;
+    conflicts.reserve(target);
+    unordered_set<uint64_t> seen;
+    seen.reserve(target * 2);
+
+    // Heavy-tailed samplers hit the same pairs often, so give up after enough attempts
+    long long attempts = 0, max_attempts = 20 * target + 1000;
+    while ((long long)conflicts.size() < target && attempts++ < max_attempts) {
+        int u = endpoint(), v = endpoint();
+        if (u == v) continue;
+        if (u > v) swap(u, v);
+        uint64_t key = (uint64_t)u * (uint64_t)params.J + (uint64_t)v;
+        if (!seen.insert(key).second) continue;
+        conflicts.push_back({u, v});
+    }
+    return conflicts;
+}
+
+/**
+ * @brief Writes an instance in the format read by read_instance (ils.cpp / ils_time.cpp).
+ *
+ * @param out Output stream.
+ * @param B Budget per team.
+ * @param salaries The salary of each player.
+ * @param conflicts The conflict pairs (0-based, written 1-based).
+ *
+ * @return void
+ */
+void write_instance(ostream &out, int B, const vector<int> &salaries, const vector<pair<int,int>> &conflicts) {
+    out << B << "\n";
+    out << salaries.size() << " " << conflicts.size() << "\n";
+    for (int s : salaries) out << s << "\n";
+    for (const auto &c : conflicts) out << c.first + 1 << " " << c.second + 1 << "\n";
+}
+
+
+int main(int argc, char* argv[]) {
+    // Checks for right amount of arguments
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0]
+        << " <players> <seed> [--budget B] [--degree D] [--density P]"
+        << " [--degree_distribution uniform|powerlaw] [--powerlaw_exponent G]"
+        << " [--salary_distribution uniform|normal] [--salary_min N] [--salary_max N]"
+        << " [--output FILE]\n";
+        return 1;
+    }
+
+    // Read arguments
+    GeneratorParams params;
+    params.J = stoi(argv[1]);
+    int seed = stoi(argv[2]);
+    string output_file;
+
+    // Check optional arguments
+    for (int a = 3; a < argc; a++) {
+        string flag = argv[a];
+        if (a + 1 >= argc) {
+            cerr << "Missing value for option: " << flag << "\n";
+            return 1;
+        }
+        if (flag == "--budget") {
+            params.B = stoi(argv[++a]);
+        } else if (flag == "--degree") {
+            params.degree = stod(argv[++a]);
+        } else if (flag == "--density") {
+            params.density = stod(argv[++a]);
+        } else if (flag == "--degree_distribution") {
+            params.degree_distribution = argv[++a];
+        } else if (flag == "--powerlaw_exponent") {
+            params.powerlaw_exponent = stod(argv[++a]);
+        } else if (flag == "--salary_distribution") {
+            params.salary_distribution = argv[++a];
+        } else if (flag == "--salary_min") {
+            params.salary_min = stoi(argv[++a]);
+        } else if (flag == "--salary_max") {
+            params.salary_max = stoi(argv[++a]);
+        } else if (flag == "--output") {
+            output_file = argv[++a];
+        } else {
+            cerr << "Unknown option: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    if (params.J < 2 || params.salary_min < 1 || params.salary_min > params.salary_max || params.salary_max > params.B) {
+        cerr << "Error: need at least 2 players and 1 <= salary_min <= salary_max <= budget\n";
+        return 1;
+    }
+    if (params.degree_distribution != "uniform" && params.degree_distribution != "powerlaw") {
+        cerr << "Unknown degree distribution: " << params.degree_distribution << "\n";
+        return 1;
+    }
+    if (!(params.powerlaw_exponent > 1)) { // the Chung-Lu weights use 1 / (exponent - 1)
+        cerr << "Error: powerlaw_exponent must be greater than 1\n";
+        return 1;
+    }
+    if (!(params.degree >= 0)) {
+        cerr << "Error: degree must be non-negative\n";
+        return 1;
+    }
+    if (params.density != -1 && !(params.density >= 0 && params.density <= 1)) { // -1: not given
+        cerr << "Error: density must be between 0 and 1\n";
+        return 1;
+    }
+    if (params.salary_distribution != "uniform" && params.salary_distribution != "normal") {
+        cerr << "Unknown salary distribution: " << params.salary_distribution << "\n";
+        return 1;
+    }
+
+    mt19937_64 rng(seed);
+    vector<int> salaries = generate_salaries(params, rng);
+    vector<pair<int,int>> conflicts = generate_conflicts(params, rng);
+
+    if (output_file.empty()) {
+        ios::sync_with_stdio(false);
+        write_instance(cout, params.B, salaries, conflicts);
+    } else {
+        ofstream out(output_file);
+        if (!out.is_open()) {
+            cerr << "Error: Could not open file " << output_file << "\n";
+            return 1;
+        }
+        write_instance(out, params.B, salaries, conflicts);
+    }
+
+    cerr << "Generated " << params.J << " players and " << conflicts.size() << " conflicts.\n";
+    return 0;
+}
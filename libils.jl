@@ -0,0 +1,120 @@
+# Interface julia para a heurística em C++ (API C de ils.h), chamada via ccall no mesmo processo.
+# A biblioteca precisa ser compilada antes com `make libils.so`.
+
+const LIBILS = joinpath(@__DIR__, "libils.so")
+isfile(LIBILS) || error("$LIBILS não encontrada: compile com `make libils.so`")
+
+# Mesmo layout de ils_params (ils.h)
+struct IlsParams
+    time_limit::Float64
+    max_iterations::Cint
+    seed::UInt64
+    perturbation_ratio::Float64
+    pool_interval::Cint
+    alns::Cint
+    acceptance::Cint
+    stagnation_limit::Cint
+    matching::Cint
+    exact_interval::Cint
+    exact_nodes::Int64
+    constructor::Cint
+end
+
+# Mesmo layout de ils_stats (ils.h)
+struct IlsStats
+    initial_teams::Cint
+    teams::Cint
+    improvements::Cint
+    iterations::Cint
+    seconds::Float64
+end
+
+# Instância carregada na biblioteca (liberada pelo garbage collector)
+mutable struct IlsInstance
+    handle::Ptr{Cvoid}
+    players::Int
+end
+
+function ils_error()
+    msg = unsafe_string(ccall((:ils_last_error, LIBILS), Cstring, ()))
+    error("libils: $msg")
+end
+
+function wrap_instance(handle::Ptr{Cvoid})
+    handle == C_NULL && ils_error()
+    players = Int(ccall((:ils_player_count, LIBILS), Cint, (Ptr{Cvoid},), handle))
+    instance = IlsInstance(handle, players)
+    finalizer(i -> ccall((:ils_free_instance, LIBILS), Cvoid, (Ptr{Cvoid},), i.handle), instance)
+    return instance
+end
+
+# Carrega um arquivo de instância
+function ils_load(filename::String)
+    return wrap_instance(ccall((:ils_load_file, LIBILS), Ptr{Cvoid}, (Cstring, Csize_t), filename, 0))
+end
+
+# Carrega uma instância já lida em julia (conflitos com índices a partir de 1)
+function ils_load(B::Int, salarios::Vector{Int}, conflitos::Vector{Tuple{Int,Int}})
+    pares = Cint[]
+    for (a, b) in conflitos
+        push!(pares, a, b)
+    end
+    handle = ccall((:ils_load_arrays, LIBILS), Ptr{Cvoid}, (Cint, Cint, Ptr{Cint}, Cint, Ptr{Cint}),
+                   B, length(salarios), Cint.(salarios), length(conflitos), pares)
+    return wrap_instance(handle)
+end
+
+# Parâmetros default do ils_time, com os campos passados sobrescritos
+function ils_params(; kwargs...)
+    ref = Ref{IlsParams}()
+    ccall((:ils_default_params, LIBILS), Cvoid, (Ref{IlsParams},), ref)
+    defaults = ref[]
+    values = (convert(fieldtype(IlsParams, f), get(kwargs, f, getfield(defaults, f))) for f in fieldnames(IlsParams))
+    return IlsParams(values...)
+end
+
+# Construção inicial First Fit Decreasing (maior salário primeiro; a seed desempata salários
+# iguais); devolve o time de cada jogador
+function ils_construct(instance::IlsInstance, seed::Int=1)
+    assignment = zeros(Cint, instance.players)
+    teams = ccall((:ils_construct, LIBILS), Cint, (Ptr{Cvoid}, UInt64, Ptr{Cint}), instance.handle, seed, assignment)
+    teams < 0 && ils_error()
+    return Int.(assignment)
+end
+
+# Roda o ILS (a partir de `initial`, se dado); devolve o time de cada jogador e as estatísticas
+function ils_solve(instance::IlsInstance; initial::Union{Nothing,Vector{Int}}=nothing, kwargs...)
+    params = Ref(ils_params(; kwargs...))
+    stats = Ref{IlsStats}()
+    assignment = zeros(Cint, instance.players)
+    initial_ptr = initial === nothing ? C_NULL : Cint.(initial)
+    teams = ccall((:ils_solve, LIBILS), Cint, (Ptr{Cvoid}, Ref{IlsParams}, Ptr{Cint}, Ptr{Cint}, Ref{IlsStats}),
+                  instance.handle, params, initial_ptr, assignment, stats)
+    teams < 0 && ils_error()
+    return Int.(assignment), stats[]
+end
+
+# Aplica um arquivo de delta (formato no README) e devolve a instância atualizada
+function ils_apply_delta(instance::IlsInstance, delta_file::String)
+    return wrap_instance(ccall((:ils_apply_delta, LIBILS), Ptr{Cvoid}, (Ptr{Cvoid}, Cstring), instance.handle, delta_file))
+end
+
+# Conserta a atribuição da instância anterior para a instância devolvida por ils_apply_delta;
+# devolve a nova atribuição e quantos jogadores foram reinseridos
+function ils_repair(updated::IlsInstance, previous::Vector{Int})
+    assignment = zeros(Cint, updated.players)
+    ejected = Ref{Cint}(0)
+    teams = ccall((:ils_repair, LIBILS), Cint, (Ptr{Cvoid}, Ptr{Cint}, Ptr{Cint}, Ref{Cint}),
+                  updated.handle, Cint.(previous), assignment, ejected)
+    teams < 0 && ils_error()
+    return Int.(assignment), Int(ejected[])
+end
+
+# Agrupa a atribuição em times (lista de jogadores de cada time)
+function ils_teams(assignment::Vector{Int})
+    teams = [Int[] for _ in 1:maximum(assignment)]
+    for (player, team) in enumerate(assignment)
+        push!(teams[team], player)
+    end
+    return teams
+end
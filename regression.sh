@@ -0,0 +1,100 @@
+#!/usr/bin/env bash
+# Regressão de desempenho do ils_time.
+#
+# Cada linha de regression_baseline.csv é um caso (instância, seed, perturbation_ratio,
+# número de iterações) com os valores de referência (times na solução final e iterações/s).
+# O caso roda com --max_iterations, então o número de times é determinístico; a vazão é
+# comparada com uma banda de tolerância. Imprime uma tabela lado a lado (com o melhor
+# resultado de 5 s registrado em ils_results.csv, só para contexto) e sai com código 1 se
+# algum caso piorar o número de times ou se a vazão média (média geométrica das razões
+# atual/referência) cair mais que o limite. Casos isolados fora da banda são marcados na
+# tabela, mas não reprovam sozinhos: a vazão de execuções curtas oscila bastante.
+#
+# Uso: ./regression.sh            compara com a referência
+#      ./regression.sh --update   regrava a referência com os valores desta máquina
+#
+# Variáveis: BIN (./ils_time), BASELINE (regression_baseline.csv), HISTORY (ils_results.csv),
+#            SLOWDOWN (queda tolerada de iterações/s, 0.15 = 15%), TEAM_TOLERANCE (0 times),
+#            REPEATS (3 execuções por caso; vale a maior vazão, que é a menos afetada por ruído).
+
+set -u
+
+BIN=${BIN:-./ils_time}
+BASELINE=${BASELINE:-regression_baseline.csv}
+HISTORY=${HISTORY:-ils_results.csv}
+SLOWDOWN=${SLOWDOWN:-0.15}
+TEAM_TOLERANCE=${TEAM_TOLERANCE:-0}
+REPEATS=${REPEATS:-3}
+
+update=0
+if [ "${1:-}" = "--update" ]; then
+    update=1
+fi
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+results="$tmp/results.csv"
+echo "instance,seed,perturbation_ratio,iterations,final_solution,iterations_per_second" > "$results"
+
+# Roda cada caso (o limite de tempo é alto: quem para a busca é --max_iterations)
+while IFS=, read -r instance seed ratio iterations _ _; do
+    ips=0
+    for ((r = 0; r < REPEATS; r++)); do
+        if ! output=$("$BIN" "$instance" 100000 "$seed" --perturbation_ratio "$ratio" \
+                      --max_iterations "$iterations" --results_file "$tmp/rows.csv"); then
+            echo "Erro ao rodar $instance (seed $seed, ratio $ratio)" >&2
+            exit 2
+        fi
+        final=$(tail -n 1 "$tmp/rows.csv" | cut -d, -f4)
+        seconds=$(echo "$output" | sed -n 's/.* finished after [0-9]* iterations in \([0-9.e+-]*\) s\./\1/p')
+        ips=$(awk -v n="$iterations" -v s="$seconds" -v best="$ips" \
+              'BEGIN { v = (s > 0) ? n / s : 0; printf "%.2f", (v > best) ? v : best }')
+    done
+    echo "$instance,$seed,$ratio,$iterations,$final,$ips" >> "$results"
+done < <(tail -n +2 "$BASELINE")
+
+if [ "$update" = 1 ]; then
+    cp "$results" "$BASELINE"
+    echo "Referência regravada em $BASELINE"
+    exit 0
+fi
+
+# Tabela lado a lado e veredito
+awk -F, -v slowdown="$SLOWDOWN" -v tolerance="$TEAM_TOLERANCE" -v history="$HISTORY" '
+BEGIN {
+    while ((getline line < history) > 0) {
+        split(line, f, ",")
+        if (f[6] != 5) continue
+        key = f[1] "," f[7] "," f[8] + 0
+        if (!(key in best) || f[4] + 0 < best[key]) best[key] = f[4] + 0
+    }
+}
+FNR == 1 { next }
+NR == FNR { ref_final[FNR] = $5; ref_ips[FNR] = $6; next }
+{
+    if (!header++) {
+        printf "%-18s %4s %5s %6s | %5s %5s %5s | %9s %9s %7s | %s\n",
+               "instance", "seed", "ratio", "iters", "ref", "now", "5s", "ref it/s", "now it/s", "diff", "status"
+    }
+    key = $1 "," $2 "," $3 + 0
+    diff = 0
+    if (ref_ips[FNR] > 0 && $6 > 0) {
+        diff = ($6 - ref_ips[FNR]) / ref_ips[FNR]
+        log_ratio += log($6 / ref_ips[FNR])
+        timed++
+    }
+    status = "ok"
+    if ($5 > ref_final[FNR] + tolerance) { status = "PIOROU"; worse++ }
+    else if (diff < -slowdown) status = "lento"
+    else if ($5 < ref_final[FNR]) status = "melhorou"
+    printf "%-18s %4s %5s %6s | %5s %5s %5s | %9.2f %9.2f %+6.1f%% | %s\n",
+           $1, $2, $3, $4, ref_final[FNR], $5, (key in best) ? best[key] : "-", ref_ips[FNR], $6, 100 * diff, status
+}
+END {
+    mean = timed ? exp(log_ratio / timed) - 1 : 0
+    printf "\nVazão média: %+.1f%% (tolerância -%.0f%%)\n", 100 * mean, 100 * slowdown
+    if (worse) printf "%d caso(s) com mais de %d time(s) acima da referência.\n", worse, tolerance
+    if (mean < -slowdown) print "Vazão abaixo da tolerância."
+    if (worse || mean < -slowdown) exit 1
+    print "Todos os casos dentro da tolerância."
+}' "$BASELINE" "$results"